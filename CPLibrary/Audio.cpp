@@ -3,10 +3,13 @@
 #include "Audio.h"
 #include "Logging.h"
 
+#include <algorithm>
+
 namespace CPL {
     ma_engine AudioManager::engine;
     std::unique_ptr<ma_sound> AudioManager::music;
-    std::vector<std::unique_ptr<ma_sound>> AudioManager::activeSounds;
+    std::vector<AudioManager::Sound> AudioManager::sounds;
+    std::unordered_map<std::string, int> AudioManager::soundsByPath;
 
     void AudioManager::Init() {
         if (ma_engine_init(nullptr, &engine) != MA_SUCCESS) {
@@ -15,42 +18,56 @@ namespace CPL {
         }
     }
 
-    Audio AudioManager::LoadAudio(const std::string& audioPath) {
-        return {audioPath};
+    Audio AudioManager::LoadAudio(const std::string& audioPath, const int voices) {
+        if (const auto found = soundsByPath.find(audioPath); found != soundsByPath.end()) return {audioPath, found->second};
+
+        Sound sound;
+        sound.voices = std::make_unique<ma_sound[]>(std::max(1, voices));
+        if (ma_sound_init_from_file(&engine, audioPath.c_str(), MA_SOUND_FLAG_DECODE, nullptr, nullptr, &sound.voices[0]) != MA_SUCCESS) {
+            Logging::Log(2, "Failed to load audio: " + audioPath);
+            // Cached too, so playing a missing file does not try to decode it (and log) again on every call
+            soundsByPath.emplace(audioPath, -1);
+            return {audioPath, -1};
+        }
+        sound.voiceCount = 1;
+        ma_sound_set_looping(&sound.voices[0], MA_FALSE);
+        // Copies reference the decoded data in the resource manager instead of decoding the file again
+        for (int v = 1; v < voices; v++) {
+            if (ma_sound_init_copy(&engine, &sound.voices[0], 0, nullptr, &sound.voices[v]) != MA_SUCCESS) break;
+            ma_sound_set_looping(&sound.voices[v], MA_FALSE);
+            sound.voiceCount++;
+        }
+
+        const int index = static_cast<int>(sounds.size());
+        sounds.push_back(std::move(sound));
+        soundsByPath.emplace(audioPath, index);
+        return {audioPath, index};
+    }
+
+    int AudioManager::Find(const Audio& audio) {
+        if (audio.index >= 0 && audio.index < static_cast<int>(sounds.size())) return audio.index;
+        return LoadAudio(audio.path).index;
     }
 
-    void AudioManager::Update() {
-        std::erase_if(activeSounds, [](auto& s) {
-            if (!ma_sound_is_playing(s.get())) {
-                ma_sound_uninit(s.get());
-                return true;
-            }
-            return false;
-        });
+    void AudioManager::Play(const Audio& audio, const float pitch) {
+        const int index = Find(audio);
+        if (index < 0) return;
+        Sound& sound = sounds[index];
+        // Round robin: the next voice is the free one or the one started longest ago
+        ma_sound* voice = &sound.voices[sound.next];
+        sound.next = (sound.next + 1) % sound.voiceCount;
+        ma_sound_stop(voice);
+        ma_sound_seek_to_pcm_frame(voice, 0);
+        ma_sound_set_pitch(voice, pitch);
+        ma_sound_start(voice);
     }
 
     void AudioManager::PlaySFX(const Audio& audio) {
-        auto sound = std::make_unique<ma_sound>();
-        if (ma_sound_init_from_file(&engine, audio.path.c_str(), MA_SOUND_FLAG_DECODE, nullptr, nullptr, sound.get()) != MA_SUCCESS) {
-            Logging::Log(2, "Failed to initialize SFX!");
-            return;
-        }
-        ma_sound_set_pitch(sound.get(), 1.0f);
-        ma_sound_set_looping(sound.get(), MA_FALSE);
-        ma_sound_start(sound.get());
-        activeSounds.push_back(std::move(sound));
+        Play(audio, 1.0f);
     }
 
     void AudioManager::PlaySFXPitch(const Audio& audio, const float pitch) {
-        auto sound = std::make_unique<ma_sound>();
-        if (ma_sound_init_from_file(&engine, audio.path.c_str(), MA_SOUND_FLAG_DECODE, nullptr, nullptr, sound.get()) != MA_SUCCESS) {
-            Logging::Log(2, "Failed to initialize SFX!");
-            return;
-        }
-        ma_sound_set_pitch(sound.get(), pitch);
-        ma_sound_set_looping(sound.get(), MA_FALSE);
-        ma_sound_start(sound.get());
-        activeSounds.push_back(std::move(sound));
+        Play(audio, pitch);
     }
 
     void AudioManager::PlayMusic(const Audio& audio) {
@@ -99,6 +116,16 @@ namespace CPL {
     }
 
     void AudioManager::Close() {
+        for (Sound& sound : sounds) {
+            // Copies first, voices[0] owns the decoded data they reference
+            for (int v = sound.voiceCount - 1; v >= 0; v--) ma_sound_uninit(&sound.voices[v]);
+        }
+        sounds.clear();
+        soundsByPath.clear();
+        if (music) {
+            ma_sound_uninit(music.get());
+            music.reset();
+        }
         ma_engine_uninit(&engine);
     }
 }
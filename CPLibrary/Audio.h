@@ -4,18 +4,25 @@
 #include <string>
 #include "CPL.h"
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace CPL {
+    // index is the decoded sound of LoadAudio, an Audio made from a path alone is loaded on its first play
     struct Audio {
         std::string path;
+        int index = -1;
     };
 
     class AudioManager {
     public:
         static void Init();
-        static void Update();
-        static Audio LoadAudio(const std::string& audioPath);
+        // Decodes the file once into the engine's resource manager and prepares voices copies of it that share
+        // the decoded data. Loading the same path again returns the same sound.
+        static Audio LoadAudio(const std::string& audioPath, int voices = defaultVoices);
 
+        // Starts the next voice of the sound, no decoding or allocation. Voices are used in turn, so the one reused
+        // is the one started longest ago (cut off if it still plays) and at most "voices" copies play at once.
         static void PlaySFX(const Audio& audio);
         static void PlaySFXPitch(const Audio& audio, float pitch);
         static void PlayMusic(const Audio& audio);
@@ -24,9 +31,23 @@ namespace CPL {
         static void PauseMusic();
         static void ResumeMusic();
         static void StopMusic();
+
+        static constexpr int defaultVoices = 8;
     private:
+        // voices[0] was initialized from the file and keeps the decoded data alive, the others are copies of it
+        struct Sound {
+            std::unique_ptr<ma_sound[]> voices;
+            int voiceCount = 0;
+            int next = 0;
+        };
+
+        static int Find(const Audio& audio);
+        static void Play(const Audio& audio, float pitch);
+
         static ma_engine engine;
         static std::unique_ptr<ma_sound> music;
-        static std::vector<std::unique_ptr<ma_sound>> activeSounds;
+        static std::vector<Sound> sounds;
+        // -1 for a path that failed to load
+        static std::unordered_map<std::string, int> soundsByPath;
     };
 }
\ No newline at end of file
@@ -5,22 +5,59 @@
 #include "shapes2D/Circle.h"
 #include "shapes2D/Line.h"
 #include "Shader.h"
+#include "ShapeBatch.h"
+#include "TextureManager.h"
 #include "Text.h"
 #include "shapes2D/Texture2D.h"
+#include "shapes2D/CanvasTexture.h"
 #include "timers/TimerManager.h"
 #include "stb_image.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace CPL {
     Shader shapeShader;
+    Shader batchShader;
     Shader textShader;
     Shader textureShader;
 
+    namespace {
+        // Uniform buffer behind the "Matrices" block of every shader: projection of the current scope, then the
+        // y-up screen projection of the text. The last uploaded projection is kept so a scope with the same one
+        // (most of them) uploads nothing.
+        unsigned int matricesUBO = 0;
+        glm::mat4 uploadedProjection{0.0f};
+
+        void InitMatrices() {
+            const glm::mat4 textProjection = glm::ortho(
+                0.0f, static_cast<float>(SCREEN_WIDTH),
+                0.0f, static_cast<float>(SCREEN_HEIGHT)
+            );
+            glGenBuffers(1, &matricesUBO);
+            glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
+            glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+            glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(textProjection));
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            glBindBufferBase(GL_UNIFORM_BUFFER, Shader::matricesBinding, matricesUBO);
+        }
+
+        void UploadProjection(const glm::mat4& matrix) {
+            if (std::memcmp(&matrix, &uploadedProjection, sizeof(glm::mat4)) == 0) return;
+            uploadedProjection = matrix;
+            glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(matrix));
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        }
+    }
+
     void UpdateCPL() {
         UpdateInput();
         CalculateDeltaTime();
         CalculateFPS();
+        CalculateRenderStats();
         TimerManager::Update(GetDeltaTime());
-        AudioManager::Update();
+        TextureManager::Update();
     }
 
     void ShowDetails() {
@@ -32,7 +69,9 @@ namespace CPL {
         const std::string versionString(reinterpret_cast<const char*>(version));
 
         BeginDrawing(TEXT, false);
-        const std::string fpsText = "FPS: " + std::to_string(GetFPS());
+        const RenderStats stats = GetRenderStats();
+        const std::string fpsText = "FPS: " + std::to_string(GetFPS()) + " | Skipped: " + std::to_string(GetSkippedFPS()) + " | Draw calls: " + std::to_string(stats.drawCalls)
+            + " (" + std::to_string(stats.instances) + " shapes)";
         DrawTextShadow({0, 25}, {2, 2}, 0.3, fpsText, WHITE, DARK_GRAY);
         const std::string vendorText = "Vendor: " + vendorString;
         DrawTextShadow({0, 60}, {2, 2}, 0.3, vendorText, WHITE, DARK_GRAY);
@@ -89,12 +128,22 @@ namespace CPL {
         }
         glfwMakeContextCurrent(window);
         glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetWindowRefreshCallback(window, [](GLFWwindow*) { RequestRedraw(); });
+        glfwSetKeyCallback(window, key_callback);
+        glfwSetMouseButtonCallback(window, mouse_button_callback);
+        glfwSetCursorPosCallback(window, cursor_position_callback);
+        double cursorX, cursorY;
+        glfwGetCursorPos(window, &cursorX, &cursorY);
+        mousePosition = {cursorX, cursorY};
         if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))) {
             std::cout << "Failed to initialize GLAD" << std::endl;
             exit(-1);
         }
 
         InitShaders();
+        InitMatrices();
+        ShapeBatch::Init();
+        TextureManager::Init();
         Text::Init("assets/fonts/default.ttf", "defaultFont", NEAREST);
         AudioManager::Init();
 
@@ -102,6 +151,31 @@ namespace CPL {
         glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     }
 
+    void SetEventDriven(const bool enabled, const double timeout) {
+        eventDriven = enabled;
+        idleTimeout = timeout;
+        RequestRedraw();
+    }
+
+    bool BeginFrame() {
+        if (eventDriven && !redrawRequested) {
+            nbSkipped++;
+            return false;
+        }
+        redrawRequested = false;
+        return true;
+    }
+
+    void WaitEvents() {
+        if (!eventDriven || redrawRequested) {
+            glfwPollEvents();
+            return;
+        }
+        double timeout = idleTimeout;
+        if (const float nextTimer = TimerManager::TimeUntilNext(); nextTimer >= 0.0f) timeout = std::min(timeout, static_cast<double>(nextTimer));
+        glfwWaitEventsTimeout(timeout);
+    }
+
     void SetWindowIcon(const std::string& filePath) {
         int width, height, channels;
         stbi_load(filePath.c_str(), &width, &height, &channels, 0);
@@ -120,83 +194,79 @@ namespace CPL {
     }
 
     void CloseWindow() {
+        ShapeBatch::Close();
+        TextureManager::Close();
         glfwTerminate();
         AudioManager::Close();
     }
 
     void InitShaders() {
         shapeShader = Shader("CPLibrary/shaders/shader.vert", "CPLibrary/shaders/shader.frag");
+        batchShader = Shader("CPLibrary/shaders/batch.vert", "CPLibrary/shaders/batch.frag");
         textShader = Shader("CPLibrary/shaders/text.vert", "CPLibrary/shaders/text.frag");
         textureShader = Shader("CPLibrary/shaders/texture.vert", "CPLibrary/shaders/texture.frag");
     }
 
     void BeginDrawing(const DrawModes& mode, const bool mode2D) {
-        Shader shader{};
-        if (mode == SHAPE_2D) shader = shapeShader;
-        else if (mode == TEXT) {
-            shader = textShader;
+        const Shader* shader = &shapeShader;
+        if (mode == TEXT) {
+            shader = &textShader;
             glEnable(GL_BLEND);
             glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
             Text::Use("defaultFont");
         }
-        else if (mode == TEXTURE_2D) shader = textureShader;
+        else if (mode == TEXTURE_2D) shader = &textureShader;
 
-        shader.Use();
-        const glm::mat4 view = camera.GetViewMatrix();
-        const glm::mat4 viewProjection = projection * view;
-        shader.SetMatrix4fv("projection", mode2D ? viewProjection : projection);
+        // Shapes and text of the previous scope are drawn before the projection and program change, text keeps
+        // collecting across TEXT scopes as it always uses the screen projection
+        ShapeBatch::SetScope(shader->ID);
+        if (mode != TEXT) Text::Flush();
+        UploadProjection(mode2D ? projection * camera.GetViewMatrix() : projection);
+        shader->Use();
     }
 
+    void EndDrawing() {
+        ShapeBatch::SetScope(0);
+        Text::Flush();
+        glUseProgram(0);
+    }
+
+    // ----- Shapes go through the batch, one instanced draw per run of the same kind ----- //
     void DrawTriangle(const glm::vec2 position, const glm::vec2 size, const Color& color) {
-        const auto triangle = Triangle(position, size, color);
-        triangle.Draw(shapeShader, true);
+        ShapeBatch::Add(ShapeBatch::TRIANGLE, position + size * 0.5f, size, 0.0f, color);
     }
     void DrawTriangleRotated(const glm::vec2 position, const glm::vec2 size, const float angle, const Color& color) {
-        const auto triangle = Triangle(position, size, color);
-        triangle.rotationAngle = angle;
-        triangle.Draw(shapeShader, true);
+        ShapeBatch::Add(ShapeBatch::TRIANGLE, position + size * 0.5f, size, -glm::radians(angle), color);
     }
     void DrawTriangleOutline(const glm::vec2 position, const glm::vec2 size, const Color& color) {
-        const auto triangle = Triangle(position, size, color);
-        triangle.Draw(shapeShader, false);
+        ShapeBatch::Add(ShapeBatch::TRIANGLE_OUTLINE, position + size * 0.5f, size, 0.0f, color);
     }
     void DrawTriangleRotOut(const glm::vec2 position, const glm::vec2 size, const float angle, const Color& color) {
-        const auto triangle = Triangle(position, size, color);
-        triangle.rotationAngle = angle;
-        triangle.Draw(shapeShader, false);
+        ShapeBatch::Add(ShapeBatch::TRIANGLE_OUTLINE, position + size * 0.5f, size, -glm::radians(angle), color);
     }
 
     void DrawRectangle(const glm::vec2 position, const glm::vec2 size, const Color& color) {
-        const auto rectangle = Rectangle(position, size, color);
-        rectangle.Draw(shapeShader, true);
+        ShapeBatch::Add(ShapeBatch::RECTANGLE, position + size * 0.5f, size, 0.0f, color);
     }
     void DrawRectangleRotated(const glm::vec2 position, const glm::vec2 size, const float angle, const Color& color) {
-        const auto rectangle = Rectangle(position, size, color);
-        rectangle.rotationAngle = angle;
-        rectangle.Draw(shapeShader, true);
+        ShapeBatch::Add(ShapeBatch::RECTANGLE, position + size * 0.5f, size, glm::radians(angle), color);
     }
     void DrawRectangleOutline(const glm::vec2 position, const glm::vec2 size, const Color& color) {
-        const auto rectangle = Rectangle(position, size, color);
-        rectangle.Draw(shapeShader, false);
+        ShapeBatch::Add(ShapeBatch::RECTANGLE_OUTLINE, position + size * 0.5f, size, 0.0f, color);
     }
     void DrawRectangleRotOut(const glm::vec2 position, const glm::vec2 size, const float angle, const Color& color) {
-        const auto rectangle = Rectangle(position, size, color);
-        rectangle.rotationAngle = angle;
-        rectangle.Draw(shapeShader, false);
+        ShapeBatch::Add(ShapeBatch::RECTANGLE_OUTLINE, position + size * 0.5f, size, glm::radians(angle), color);
     }
 
     void DrawCircle(const glm::vec2 position, const float radius, const Color& color) {
-        const auto circle = Circle(position, radius, color);
-        circle.Draw(shapeShader);
+        ShapeBatch::Add(ShapeBatch::CIRCLE, position, {radius, radius}, 0.0f, color);
     }
     void DrawCircleOutline(const glm::vec2 position, const float radius, const Color& color) {
-        const auto circle = Circle(position, radius, color);
-        circle.DrawOutline(shapeShader);
+        ShapeBatch::Add(ShapeBatch::CIRCLE_OUTLINE, position, {radius, radius}, 0.0f, color);
     }
 
     void DrawLine(const glm::vec2 startPos, const glm::vec2 endPos, const Color& color) {
-        const auto line = Line(startPos, endPos, color);
-        line.Draw(shapeShader);
+        ShapeBatch::Add(ShapeBatch::LINE, startPos, endPos - startPos, 0.0f, color);
     }
 
     void DrawTexture2D(Texture2D* texture, const glm::vec2 position, const Color& color) {
@@ -210,10 +280,15 @@ namespace CPL {
         texture->rotationAngle = angle;
         texture->Draw(textureShader);
     }
-    void DrawTex2DCpy(Texture2D texture, const glm::vec2 position, const Color& color) {
-        texture.position = position;
-        texture.color = color;
-        texture.Draw(textureShader);
+    void DrawTex2DCpy(const Texture2D& texture, const glm::vec2 position, const Color& color) {
+        texture.Draw(textureShader, position, texture.rotationAngle, color);
+    }
+
+    void DrawCanvas(CanvasTexture& canvas, const glm::vec2 position, const glm::vec2 size, const Color& color) {
+        canvas.Draw(textureShader, position, size, color);
+    }
+    void DrawCanvasGrid(const CanvasTexture& canvas, const glm::vec2 position, const glm::vec2 size, const Color& color) {
+        canvas.DrawGrid(shapeShader, position, size, color);
     }
 
     void DrawText(const glm::vec2 position, const float scale, const std::string& text, const Color& color) {
@@ -5,6 +5,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <bitset>
 #include <iostream>
 #include <random>
 #include "Colors.h"
@@ -37,6 +38,7 @@ namespace CPL {
     class Circle;
     class Line;
     class Texture2D;
+    class CanvasTexture;
 
     struct Character;
     class Text;
@@ -46,15 +48,28 @@ namespace CPL {
     inline glm::mat4 projection;
 
     extern Shader shapeShader;
+    extern Shader batchShader;
     extern Shader textShader;
     extern Shader textureShader;
 
     inline std::mt19937 gen{std::random_device{}()};
 
-    inline std::unordered_map<int, bool> keyStates;
-    inline std::unordered_map<int, bool> prevKeyStates;
-    inline std::unordered_map<int, bool> mouseButtons;
-    inline std::unordered_map<int, bool> prevMouseButtons;
+    // Input state, written by the GLFW callbacks while events are processed and snapshotted once per frame by UpdateInput
+    using KeySet = std::bitset<GLFW_KEY_LAST + 1>;
+    using MouseButtonSet = std::bitset<GLFW_MOUSE_BUTTON_LAST + 1>;
+    // Held right now, and pressed at some point since the last UpdateInput (a tap between two frames is not lost)
+    inline KeySet keysHeld;
+    inline KeySet keysLatched;
+    inline MouseButtonSet mouseButtonsHeld;
+    inline MouseButtonSet mouseButtonsLatched;
+    // Per frame: state, state of the frame before, and the bits that changed between them
+    inline KeySet keyStates;
+    inline KeySet prevKeyStates;
+    inline KeySet keyEdges;
+    inline MouseButtonSet mouseButtons;
+    inline MouseButtonSet prevMouseButtons;
+    inline MouseButtonSet mouseEdges;
+    inline glm::vec2 mousePosition{0.0f};
 
     inline GLFWwindow* window;
 
@@ -98,7 +113,10 @@ namespace CPL {
     void DrawLine(glm::vec2 startPos, glm::vec2 endPos, const Color& color);
     void DrawTexture2D(Texture2D* texture, glm::vec2 position, const Color& color);
     void DrawTexture2DRotated(Texture2D* texture, glm::vec2 position, float angle, const Color& color);
-    void DrawTex2DCpy(Texture2D texture, glm::vec2 position, const Color& color);
+    void DrawTex2DCpy(const Texture2D& texture, glm::vec2 position, const Color& color);
+    // TEXTURE_2D scope for the cells, SHAPE_2D scope for the grid
+    void DrawCanvas(CanvasTexture& canvas, glm::vec2 position, glm::vec2 size, const Color& color);
+    void DrawCanvasGrid(const CanvasTexture& canvas, glm::vec2 position, glm::vec2 size, const Color& color);
 
     void DrawText(glm::vec2 position, float scale, const std::string& text, const Color& color);
     void DrawTextShadow(glm::vec2 position, glm::vec2 shadowOffset, float scale, const std::string& text, const Color& color, const Color& shadowColor);
@@ -110,30 +128,98 @@ namespace CPL {
 
     void BeginDrawing(const DrawModes& mode, bool mode2D);
 
-    inline void EndDrawing() {
-        glUseProgram(0);
+    void EndDrawing();
+
+    // ----- Event driven loop: frames are only drawn when something asked for it ----- //
+    inline bool eventDriven = false;
+    inline double idleTimeout = 0.5;
+    inline bool redrawRequested = true;
+
+    // Input, timers firing and window refreshes request a redraw on their own, call it for any other change
+    inline void RequestRedraw() {
+        redrawRequested = true;
     }
+    // idleTimeout bounds the wait, so code polled from the loop (background work) still runs that often
+    void SetEventDriven(bool enabled, double timeout = 0.5);
+    // Always true unless event driven, otherwise true when a redraw was requested. Skip drawing and swapping when false.
+    bool BeginFrame();
+    // End of the loop: polls the events, or when event driven and nothing is pending, sleeps until an event,
+    // the next timer or idleTimeout
+    void WaitEvents();
 
     // [[maybe_unused]] so CLion doesn't annoy me with redundant window
     inline void framebuffer_size_callback([[maybe_unused]] GLFWwindow* window, const int width, const int height) {
         glViewport(0, 0, width, height);
+        RequestRedraw();
+    }
+
+    inline void key_callback([[maybe_unused]] GLFWwindow* window, const int key, [[maybe_unused]] const int scancode, const int action, [[maybe_unused]] const int mods) {
+        if (key < 0 || key > GLFW_KEY_LAST || action == GLFW_REPEAT) return;
+        if (action == GLFW_PRESS) {
+            keysHeld.set(key);
+            keysLatched.set(key);
+        }
+        else {
+            keysHeld.reset(key);
+        }
+        RequestRedraw();
+    }
+    inline void mouse_button_callback([[maybe_unused]] GLFWwindow* window, const int button, const int action, [[maybe_unused]] const int mods) {
+        if (button < 0 || button > GLFW_MOUSE_BUTTON_LAST) return;
+        if (action == GLFW_PRESS) {
+            mouseButtonsHeld.set(button);
+            mouseButtonsLatched.set(button);
+        }
+        else {
+            mouseButtonsHeld.reset(button);
+        }
+        RequestRedraw();
+    }
+    inline void cursor_position_callback([[maybe_unused]] GLFWwindow* window, const double x, const double y) {
+        mousePosition = {x, y};
+        RequestRedraw();
     }
 
     inline double lastTime = 0.0;
     inline int nbFrames = 0;
+    inline int nbSkipped = 0;
     inline int FPS;
+    inline int skippedFPS;
     inline void CalculateFPS() {
         const double currentTime = glfwGetTime();
         nbFrames++;
         if (currentTime - lastTime >= 1.0) {
-            FPS = nbFrames;
+            FPS = nbFrames - nbSkipped;
+            skippedFPS = nbSkipped;
             nbFrames = 0;
-            lastTime += 1.0;
+            nbSkipped = 0;
+            // After a long idle wait start over instead of catching up one second per frame
+            lastTime = currentTime - lastTime >= 2.0 ? currentTime : lastTime + 1.0;
         }
     }
+    // Frames drawn in the last second
     inline int GetFPS() {
         return FPS;
     }
+    // Loop iterations of the last second that skipped drawing (event driven only)
+    inline int GetSkippedFPS() {
+        return skippedFPS;
+    }
+
+    struct RenderStats {
+        int drawCalls = 0;
+        int instances = 0;
+    };
+    inline RenderStats frameStats;
+    inline RenderStats lastFrameStats;
+    // Called once per frame, GetRenderStats then returns the totals of the frame before
+    inline void CalculateRenderStats() {
+        lastFrameStats = frameStats;
+        frameStats = {};
+    }
+    inline RenderStats GetRenderStats() {
+        return lastFrameStats;
+    }
 
     inline float deltaTime = 0;
     inline float lastFrame = 0;
@@ -184,16 +270,17 @@ namespace CPL {
         return dist(gen) <= percent;
     }
 
+    // A few word sized bitset operations, the callbacks already did the per event work
     inline void UpdateInput() {
         prevKeyStates = keyStates;
-        for (int key = GLFW_KEY_SPACE; key <= GLFW_KEY_LAST; key++) {
-            keyStates[key] = glfwGetKey(window, key) == GLFW_PRESS;
-        }
+        keyStates = keysHeld | keysLatched;
+        keysLatched.reset();
+        keyEdges = keyStates ^ prevKeyStates;
 
         prevMouseButtons = mouseButtons;
-        for (int button = GLFW_MOUSE_BUTTON_1; button <= GLFW_MOUSE_BUTTON_LAST; button++) {
-            mouseButtons[button] = glfwGetMouseButton(window, button) == GLFW_PRESS;
-        }
+        mouseButtons = mouseButtonsHeld | mouseButtonsLatched;
+        mouseButtonsLatched.reset();
+        mouseEdges = mouseButtons ^ prevMouseButtons;
     }
 
     inline bool IsKeyDown(const int key) {
@@ -203,25 +290,23 @@ namespace CPL {
         return !keyStates[key];
     }
     inline bool IsKeyPressedOnce(const int key) {
-        return keyStates[key] && !prevKeyStates[key];
+        return keyEdges[key] && keyStates[key];
     }
     inline bool IsKeyReleased(const int key) {
-        return !keyStates[key] && prevKeyStates[key];
+        return keyEdges[key] && !keyStates[key];
     }
 
     inline bool IsMouseDown(const int button) {
         return mouseButtons[button];
     }
     inline bool IsMousePressedOnce(const int button) {
-        return mouseButtons[button] && !prevMouseButtons[button];
+        return mouseEdges[button] && mouseButtons[button];
     }
     inline bool IsMouseReleased(const int button) {
-        return !mouseButtons[button] && prevMouseButtons[button];
+        return mouseEdges[button] && !mouseButtons[button];
     }
     inline glm::vec2 GetMousePosition() {
-        double x, y;
-        glfwGetCursorPos(window, &x, &y);
-        return {x, y};
+        return mousePosition;
     }
     inline glm::vec2 GetMousePositionWorld() {
         const glm::vec2 screenCenter = { GetScreenWidth() / 2.0f, GetScreenHeight() / 2.0f };
@@ -8,8 +8,11 @@
 #include "../CPLibrary/shapes2D/Rectangle.h"
 #include "../CPLibrary/shapes2D/Line.h"
 #include "../CPLibrary/shapes2D/Texture2D.h"
+#include "../CPLibrary/shapes2D/CanvasTexture.h"
 #include "../CPLibrary/timers/TimerManager.h"
 #include "../CPLibrary/Shader.h"
+#include "../CPLibrary/ShapeBatch.h"
+#include "../CPLibrary/TextureManager.h"
 #include "../CPLibrary/Text.h"
 #include "../CPLibrary/CPL.h"
 #include "../CPLibrary/Audio.h"
@@ -1,5 +1,6 @@
 #pragma once
 
+#define BLANK Color{0, 0, 0, 0}
 #define BLACK Color{0, 0, 0, 255}
 #define DARK_GRAY Color{50, 50, 50, 255}
 #define GRAY Color{145, 145, 145, 255}
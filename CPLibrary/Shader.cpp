@@ -2,6 +2,7 @@
 #include "CPL.h"
 #include "Logging.h"
 
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -52,6 +53,37 @@ namespace CPL {
 
         glDeleteShader(vertex);
         glDeleteShader(fragment);
+
+        CacheUniforms();
+    }
+
+    void Shader::CacheUniforms() {
+        int count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::string name(std::max(maxLength, 1), '\0');
+        for (int i = 0; i < count; i++) {
+            int length = 0, size = 0;
+            GLenum type;
+            glGetActiveUniform(ID, i, maxLength, &length, &size, &type, name.data());
+            // Members of a uniform block are listed too, they have no location
+            const int location = glGetUniformLocation(ID, name.c_str());
+            if (location >= 0) uniforms.emplace_back(name.substr(0, length), location);
+        }
+
+        constexpr const char* names[UNIFORM_COUNT] = {"transform", "offset", "inputColor", "sdf"};
+        for (int u = 0; u < UNIFORM_COUNT; u++) locations[u] = GetLocation(names[u]);
+
+        if (const unsigned int block = glGetUniformBlockIndex(ID, "Matrices"); block != GL_INVALID_INDEX) {
+            glUniformBlockBinding(ID, block, matricesBinding);
+        }
+    }
+
+    int Shader::GetLocation(const std::string& name) const {
+        for (const auto& [uniformName, location] : uniforms) {
+            if (uniformName == name) return location;
+        }
+        return -1;
     }
 
     void Shader::Use() const {
@@ -59,27 +91,51 @@ namespace CPL {
     }
 
     void Shader::SetBool(const std::string& name, const bool value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), static_cast<int>(value));
+        glUniform1i(GetLocation(name), static_cast<int>(value));
     }
 
     void Shader::SetInt(const std::string& name, const int value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1i(GetLocation(name), value);
     }
 
     void Shader::SetFloat(const std::string& name, const float value) const {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1f(GetLocation(name), value);
     }
 
     void Shader::SetColor(const std::string& name, const Color& color) const {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), color.r, color.g, color.b, color.a);
+        glUniform4f(GetLocation(name), color.r, color.g, color.b, color.a);
     }
 
     void Shader::SetMatrix4fv(const std::string& name, const glm::mat4& matrix) const {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(matrix));
+        glUniformMatrix4fv(GetLocation(name), 1, GL_FALSE, glm::value_ptr(matrix));
     }
 
     void Shader::SetVector3f(const std::string& name, const glm::vec3& vec3) const {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), vec3.x, vec3.y, vec3.z);
+        glUniform3f(GetLocation(name), vec3.x, vec3.y, vec3.z);
+    }
+
+    void Shader::SetBool(const Uniform uniform, const bool value) const {
+        glUniform1i(locations[uniform], static_cast<int>(value));
+    }
+
+    void Shader::SetInt(const Uniform uniform, const int value) const {
+        glUniform1i(locations[uniform], value);
+    }
+
+    void Shader::SetFloat(const Uniform uniform, const float value) const {
+        glUniform1f(locations[uniform], value);
+    }
+
+    void Shader::SetColor(const Uniform uniform, const Color& color) const {
+        glUniform4f(locations[uniform], color.r, color.g, color.b, color.a);
+    }
+
+    void Shader::SetMatrix4fv(const Uniform uniform, const glm::mat4& matrix) const {
+        glUniformMatrix4fv(locations[uniform], 1, GL_FALSE, glm::value_ptr(matrix));
+    }
+
+    void Shader::SetVector3f(const Uniform uniform, const glm::vec3& vec3) const {
+        glUniform3f(locations[uniform], vec3.x, vec3.y, vec3.z);
     }
 
     void Shader::CheckCompileErrors(const unsigned int shader, const std::string& type) {
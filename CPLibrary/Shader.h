@@ -1,6 +1,9 @@
 #pragma once
 
+#include <array>
 #include <string>
+#include <utility>
+#include <vector>
 #include <glm/gtc/type_ptr.hpp>
 
 namespace CPL {
@@ -8,18 +11,47 @@ namespace CPL {
 
     class Shader {
     public:
+        // Uniforms the library sets on every draw, their locations are resolved once after linking.
+        // Setters taking one of these do no lookup at all, a uniform the program lacks is skipped (-1).
+        enum Uniform {
+            TRANSFORM,
+            OFFSET,
+            INPUT_COLOR,
+            SDF,
+            UNIFORM_COUNT,
+        };
+        // Binding point of the "Matrices" block (projection of the current scope and the text projection),
+        // one buffer shared by every program, so a new projection is one upload instead of one uniform per program
+        static constexpr unsigned int matricesBinding = 0;
+
         unsigned int ID;
         Shader() = default;
         Shader(const char* vertexPath, const char* fragmentPath);
 
         void Use() const;
+        // Location from the table filled at link time, no driver call. -1 when the program has no such uniform.
+        [[nodiscard]] int GetLocation(const std::string& name) const;
+        [[nodiscard]] int GetLocation(const Uniform uniform) const { return locations[uniform]; }
+
         void SetBool(const std::string &name, bool value) const;
         void SetInt(const std::string &name, int value) const;
         void SetFloat(const std::string &name, float value) const;
         void SetColor(const std::string &name, const Color& color) const;
         void SetMatrix4fv(const std::string &name, const glm::mat4& matrix) const;
         void SetVector3f(const std::string &name, const glm::vec3& vec3) const;
+
+        void SetBool(Uniform uniform, bool value) const;
+        void SetInt(Uniform uniform, int value) const;
+        void SetFloat(Uniform uniform, float value) const;
+        void SetColor(Uniform uniform, const Color& color) const;
+        void SetMatrix4fv(Uniform uniform, const glm::mat4& matrix) const;
+        void SetVector3f(Uniform uniform, const glm::vec3& vec3) const;
     private:
         static void CheckCompileErrors(unsigned int shader, const std::string& type);
+        void CacheUniforms();
+
+        // Every active uniform of the program, a handful per shader so a linear search beats hashing
+        std::vector<std::pair<std::string, int>> uniforms;
+        std::array<int, UNIFORM_COUNT> locations{-1, -1, -1, -1};
     };
 }
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "ShapeBatch.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "Shader.h"
+
+namespace CPL {
+    unsigned int ShapeBatch::VAO;
+    unsigned int ShapeBatch::meshVBO;
+    unsigned int ShapeBatch::instanceVBO;
+    ShapeBatch::Mesh ShapeBatch::meshes[KIND_COUNT];
+    std::vector<ShapeBatch::Instance> ShapeBatch::pending;
+    ShapeBatch::Kind ShapeBatch::pendingKind = RECTANGLE;
+    long long ShapeBatch::bufferOffset = 0;
+    unsigned int ShapeBatch::scopeProgram = 0;
+
+    void ShapeBatch::Init() {
+        // ----- Unit shapes, all kinds in one vertex buffer ----- //
+        std::vector<glm::vec2> vertices;
+        auto addMesh = [&](const Kind kind, const unsigned int mode, const std::vector<glm::vec2>& shape) {
+            meshes[kind] = {mode, static_cast<int>(vertices.size()), static_cast<int>(shape.size())};
+            vertices.insert(vertices.end(), shape.begin(), shape.end());
+        };
+        addMesh(RECTANGLE, GL_TRIANGLES, {{-0.5f, -0.5f}, {0.5f, -0.5f}, {0.5f, 0.5f}, {-0.5f, -0.5f}, {0.5f, 0.5f}, {-0.5f, 0.5f}});
+        addMesh(RECTANGLE_OUTLINE, GL_LINE_LOOP, {{0.5f, -0.5f}, {0.5f, 0.5f}, {-0.5f, 0.5f}, {-0.5f, -0.5f}});
+        addMesh(TRIANGLE, GL_TRIANGLES, {{-0.5f, -0.5f}, {0.5f, -0.5f}, {0.0f, 0.5f}});
+        meshes[TRIANGLE_OUTLINE] = {GL_LINE_LOOP, meshes[TRIANGLE].first, 3};
+
+        std::vector<glm::vec2> circle = {{0.0f, 0.0f}};
+        for (int i = 0; i <= circleSegments; i++) {
+            const float theta = 2.0f * static_cast<float>(M_PI) * static_cast<float>(i) / static_cast<float>(circleSegments);
+            circle.emplace_back(std::cos(theta), std::sin(theta));
+        }
+        addMesh(CIRCLE, GL_TRIANGLE_FAN, circle);
+        meshes[CIRCLE_OUTLINE] = {GL_LINE_LOOP, meshes[CIRCLE].first + 1, circleSegments};
+        addMesh(LINE, GL_LINES, {{0.0f, 0.0f}, {1.0f, 1.0f}});
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &meshVBO);
+        glGenBuffers(1, &instanceVBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(glm::vec2)), vertices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), static_cast<void*>(nullptr));
+        glEnableVertexAttribArray(0);
+
+        // ----- Instance stream, the attribute offsets are set per flush ----- //
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(maxInstances * sizeof(Instance)), nullptr, GL_STREAM_DRAW);
+        for (unsigned int attribute = 1; attribute <= 3; attribute++) {
+            glEnableVertexAttribArray(attribute);
+            glVertexAttribDivisor(attribute, 1);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+
+        pending.reserve(maxInstances);
+        bufferOffset = 0;
+    }
+
+    void ShapeBatch::Close() {
+        pending.clear();
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &meshVBO);
+        glDeleteBuffers(1, &instanceVBO);
+        VAO = meshVBO = instanceVBO = 0;
+    }
+
+    void ShapeBatch::SetScope(const unsigned int program) {
+        Flush();
+        scopeProgram = program;
+    }
+
+    void ShapeBatch::Add(const Kind kind, const glm::vec2 pivot, const glm::vec2 size, const float rotation, const Color& color) {
+        if (!pending.empty() && (kind != pendingKind || pending.size() == maxInstances)) Flush();
+        pendingKind = kind;
+        pending.push_back({pivot, size, color, rotation});
+    }
+
+    void ShapeBatch::Flush() {
+        if (pending.empty()) return;
+
+        const auto bytes = static_cast<long long>(pending.size() * sizeof(Instance));
+        const auto capacity = static_cast<long long>(maxInstances * sizeof(Instance));
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        if (bufferOffset + bytes > capacity) {
+            // Orphan: the driver hands out fresh storage while draws still read the old one
+            glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+            bufferOffset = 0;
+        }
+        // Unsynchronized is safe, this range was not written since the last orphan
+        if (void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, bufferOffset, bytes,
+                                            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT)) {
+            std::memcpy(mapped, pending.data(), bytes);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        else {
+            glBufferSubData(GL_ARRAY_BUFFER, bufferOffset, bytes, pending.data());
+        }
+
+        // GL 3.3 has no base instance, the instance attributes point at this run instead
+        glBindVertexArray(VAO);
+        auto at = [](const long long offset) { return reinterpret_cast<void*>(static_cast<std::uintptr_t>(offset)); };
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), at(bufferOffset + offsetof(Instance, pivot)));
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), at(bufferOffset + offsetof(Instance, color)));
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Instance), at(bufferOffset + offsetof(Instance, rotation)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        batchShader.Use();
+        const Mesh& mesh = meshes[pendingKind];
+        glDrawArraysInstanced(mesh.mode, mesh.first, mesh.count, static_cast<GLsizei>(pending.size()));
+        glBindVertexArray(0);
+        glUseProgram(scopeProgram);
+
+        frameStats.drawCalls++;
+        frameStats.instances += static_cast<int>(pending.size());
+        bufferOffset += bytes;
+        pending.clear();
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "CPL.h"
+
+namespace CPL {
+    // Collects the shapes of the Draw* functions and draws every run of one kind with a single instanced call.
+    // A run ends when another kind is added, at BeginDrawing and at EndDrawing, so the drawing order is kept.
+    // Instances are streamed into one buffer through mapped ranges, the buffer is orphaned when it is full.
+    class ShapeBatch {
+    public:
+        enum Kind {
+            RECTANGLE,
+            RECTANGLE_OUTLINE,
+            TRIANGLE,
+            TRIANGLE_OUTLINE,
+            CIRCLE,
+            CIRCLE_OUTLINE,
+            LINE,
+            KIND_COUNT,
+        };
+
+        static void Init();
+        static void Close();
+        // Flushes, then sets the program to bind again after a flush. The projection comes from the shared
+        // "Matrices" block, which BeginDrawing updates after this call.
+        static void SetScope(unsigned int program);
+        // The unit shape of the kind is scaled by size, rotated by rotation (radians) and moved to pivot
+        static void Add(Kind kind, glm::vec2 pivot, glm::vec2 size, float rotation, const Color& color);
+        static void Flush();
+    private:
+        struct Instance {
+            glm::vec2 pivot;
+            glm::vec2 size;
+            Color color;
+            float rotation;
+        };
+        struct Mesh {
+            unsigned int mode;
+            int first;
+            int count;
+        };
+
+        static constexpr int maxInstances = 16384;
+        static constexpr int circleSegments = 64;
+
+        static unsigned int VAO, meshVBO, instanceVBO;
+        static Mesh meshes[KIND_COUNT];
+        static std::vector<Instance> pending;
+        static Kind pendingKind;
+        static long long bufferOffset;
+        static unsigned int scopeProgram;
+    };
+}
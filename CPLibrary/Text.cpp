@@ -1,19 +1,156 @@
 #include "Text.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
 #include "CPL.h"
 #include "Shader.h"
 #include "Logging.h"
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace CPL {
+    namespace {
+        constexpr char atlasMagic[8] = {'C', 'P', 'L', 'F', 'O', 'N', 'T', '\0'};
+        // Bump when the layout of the file or of Character changes
+        constexpr std::uint32_t atlasCacheVersion = 1;
+
+        // Everything the rasterized atlas depends on, a cache file with another key is rebuilt
+        struct AtlasKey {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t freetypeVersion;
+            std::uint32_t pixelSize;
+            std::uint32_t sdf;
+            std::uint64_t fontBytes;
+            std::int64_t fontModified;
+            std::uint32_t pathLength;
+            std::uint32_t characterBytes;
+        };
+        struct AtlasHeader {
+            AtlasKey key;
+            std::uint32_t width;
+            std::uint32_t height;
+        };
+
+        AtlasKey MakeAtlasKey(const std::string& fontPath, const bool sdf) {
+            AtlasKey key{};
+            std::copy_n(atlasMagic, sizeof(atlasMagic), key.magic);
+            key.version = atlasCacheVersion;
+            key.freetypeVersion = FREETYPE_MAJOR * 10000 + FREETYPE_MINOR * 100 + FREETYPE_PATCH;
+            key.pixelSize = Text::pixelSize;
+            key.sdf = sdf ? 1 : 0;
+            std::error_code error;
+            key.fontBytes = std::filesystem::file_size(fontPath, error);
+            key.fontModified = static_cast<std::int64_t>(std::filesystem::last_write_time(fontPath, error).time_since_epoch().count());
+            key.pathLength = static_cast<std::uint32_t>(fontPath.size());
+            key.characterBytes = sizeof(Character);
+            return key;
+        }
+
+        // Read only view of a whole file: mmap on POSIX, a plain read elsewhere. Empty when the file is missing.
+        class FileView {
+        public:
+            explicit FileView(const std::string& path) {
+#ifdef _WIN32
+                std::ifstream in(path, std::ios::binary | std::ios::ate);
+                if (!in.is_open()) return;
+                buffer.resize(static_cast<size_t>(in.tellg()));
+                in.seekg(0);
+                if (!in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()))) return;
+                data = buffer.data();
+                size = buffer.size();
+#else
+                const int fd = open(path.c_str(), O_RDONLY);
+                if (fd < 0) return;
+                struct stat info{};
+                if (fstat(fd, &info) == 0 && info.st_size > 0) {
+                    void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (mapped != MAP_FAILED) {
+                        data = static_cast<const unsigned char*>(mapped);
+                        size = static_cast<size_t>(info.st_size);
+                    }
+                }
+                close(fd);
+#endif
+            }
+            ~FileView() {
+#ifndef _WIN32
+                if (data != nullptr) munmap(const_cast<unsigned char*>(data), size);
+#endif
+            }
+            FileView(const FileView&) = delete;
+            FileView& operator=(const FileView&) = delete;
+
+            [[nodiscard]] const unsigned char* Data() const { return data; }
+            [[nodiscard]] size_t Size() const { return size; }
+        private:
+            const unsigned char* data = nullptr;
+            size_t size = 0;
+#ifdef _WIN32
+            std::vector<unsigned char> buffer;
+#endif
+        };
+
+        // Layout: header, font path, 128 Characters, width x height atlas bytes. Returns the atlas bytes inside
+        // the view, nullptr when the file is missing, truncated or was built for another key.
+        const unsigned char* ReadAtlasCache(const FileView& cache, const AtlasKey& key, const std::string& fontPath, const int width,
+                                            Font& font, int& height) {
+            if (cache.Data() == nullptr || cache.Size() < sizeof(AtlasHeader)) return nullptr;
+            AtlasHeader header{};
+            std::memcpy(&header, cache.Data(), sizeof(header));
+            if (std::memcmp(&header.key, &key, sizeof(key)) != 0 || header.width != static_cast<std::uint32_t>(width)) return nullptr;
+
+            const size_t charactersOffset = sizeof(header) + key.pathLength;
+            const size_t pixelsOffset = charactersOffset + sizeof(font.Characters);
+            if (cache.Size() != pixelsOffset + static_cast<size_t>(header.width) * header.height) return nullptr;
+            if (fontPath.compare(0, std::string::npos, reinterpret_cast<const char*>(cache.Data() + sizeof(header)), key.pathLength) != 0) return nullptr;
+
+            std::memcpy(font.Characters.data(), cache.Data() + charactersOffset, sizeof(font.Characters));
+            height = static_cast<int>(header.height);
+            return cache.Data() + pixelsOffset;
+        }
+
+        bool WriteAtlasCache(const std::string& cachePath, const AtlasKey& key, const std::string& fontPath, const int width,
+                             const Font& font, const int height, const unsigned char* atlas) {
+            // Written to a temporary file first, a crash can not leave a half written cache behind
+            const std::string temporaryPath = cachePath + ".tmp";
+            {
+                std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+                if (!out.is_open()) return false;
+                const AtlasHeader header{key, static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height)};
+                out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                out.write(fontPath.data(), static_cast<std::streamsize>(fontPath.size()));
+                out.write(reinterpret_cast<const char*>(font.Characters.data()), sizeof(font.Characters));
+                out.write(reinterpret_cast<const char*>(atlas), static_cast<std::streamsize>(width) * height);
+                if (!out) return false;
+            }
+            std::error_code error;
+            std::filesystem::rename(temporaryPath, cachePath, error);
+            return !error;
+        }
+    }
+
     std::string Text::currentFont;
-    std::map<std::string, std::map<GLchar, Character>> Text::Fonts;
+    std::map<std::string, Font> Text::Fonts;
     unsigned int Text::VAO;
     unsigned int Text::VBO;
+    std::vector<Text::Vertex> Text::vertices;
+    const Shader* Text::batchShader = nullptr;
+    unsigned int Text::batchAtlas = 0;
+    bool Text::batchSdf = false;
 
-    void Text::Init(const std::string& fontPath, const std::string& fontName, const TextureFiltering& textureFiltering) {
+    std::vector<unsigned char> Text::RasterizeAtlas(const std::string& fontPath, const bool sdf, Font& font, int& atlasHeight) {
         // ----- Freetype ----- //
         FT_Library ft;
         if (FT_Init_FreeType(&ft)) {
@@ -32,62 +169,128 @@ namespace CPL {
             Logging::Log(2, "Failed to load font");
             exit(-1);
         }
-        FT_Set_Pixel_Sizes(face, 0, 48);
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        FT_Set_Pixel_Sizes(face, 0, pixelSize);
 
-        std::map<GLchar, Character> characters;
+        // ----- Render every glyph, then pack them in rows (shelves) of one atlas ----- //
+        struct Bitmap {
+            std::vector<unsigned char> pixels;
+            int width = 0;
+            int rows = 0;
+        };
+        std::array<Bitmap, 128> bitmaps;
         for (unsigned char c = 0; c < 128; c++) {
-            if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
+            // The SDF renderer pads the bitmap by its spread and moves the bearing to match
+            if (FT_Load_Char(face, c, sdf ? FT_LOAD_DEFAULT : FT_LOAD_RENDER)
+                || (sdf && FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF))) {
                 Logging::Log(2, "Failed to load Glyph");
                 continue;
             }
-
-            unsigned int texture;
-            glGenTextures(1, &texture);
-            glBindTexture(GL_TEXTURE_2D, texture);
-            glTexImage2D(
-                GL_TEXTURE_2D,
-                0,
-                GL_RED,
-                static_cast<GLsizei>(face->glyph->bitmap.width),
-                static_cast<GLsizei>(face->glyph->bitmap.rows),
-                0,
-                GL_RED,
-                GL_UNSIGNED_BYTE,
-                face->glyph->bitmap.buffer
-            );
-
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, textureFiltering == LINEAR ? GL_LINEAR : GL_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, textureFiltering == LINEAR ? GL_LINEAR : GL_NEAREST);
-
-            Character character = {
-                texture,
+            const FT_Bitmap& glyph = face->glyph->bitmap;
+            Bitmap& bitmap = bitmaps[c];
+            bitmap.width = static_cast<int>(glyph.width);
+            bitmap.rows = static_cast<int>(glyph.rows);
+            bitmap.pixels.resize(static_cast<size_t>(bitmap.width) * bitmap.rows);
+            for (int y = 0; y < bitmap.rows; y++) {
+                std::copy_n(glyph.buffer + static_cast<ptrdiff_t>(y) * std::abs(glyph.pitch), bitmap.width,
+                            bitmap.pixels.begin() + static_cast<ptrdiff_t>(y) * bitmap.width);
+            }
+            font.Characters[c] = {
+                {},
+                {},
                 glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
                 glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
                 static_cast<unsigned int>(face->glyph->advance.x)
             };
-            characters.insert(std::pair<char, Character>(c, character));
         }
-        Fonts.insert(std::pair(fontName, characters));
-        currentFont = fontName;
+        FT_Done_Face(face);
+        FT_Done_FreeType(ft);
+
+        // One pixel gap so linear filtering does not bleed into the neighbour glyph
+        constexpr int padding = 1;
+        std::array<glm::ivec2, 128> origins{};
+        int x = padding, y = padding, shelfHeight = 0;
+        for (int c = 0; c < 128; c++) {
+            const Bitmap& bitmap = bitmaps[c];
+            if (x + bitmap.width + padding > atlasWidth) {
+                x = padding;
+                y += shelfHeight + padding;
+                shelfHeight = 0;
+            }
+            origins[c] = {x, y};
+            x += bitmap.width + padding;
+            shelfHeight = std::max(shelfHeight, bitmap.rows);
+        }
+        atlasHeight = y + shelfHeight + padding;
+
+        std::vector<unsigned char> atlas(static_cast<size_t>(atlasWidth) * atlasHeight, 0);
+        for (int c = 0; c < 128; c++) {
+            const Bitmap& bitmap = bitmaps[c];
+            for (int row = 0; row < bitmap.rows; row++) {
+                std::copy_n(bitmap.pixels.begin() + static_cast<ptrdiff_t>(row) * bitmap.width, bitmap.width,
+                            atlas.begin() + static_cast<ptrdiff_t>(origins[c].y + row) * atlasWidth + origins[c].x);
+            }
+            font.Characters[c].AtlasMin = {static_cast<float>(origins[c].x) / atlasWidth, static_cast<float>(origins[c].y) / atlasHeight};
+            font.Characters[c].AtlasMax = {static_cast<float>(origins[c].x + bitmap.width) / atlasWidth,
+                                           static_cast<float>(origins[c].y + bitmap.rows) / atlasHeight};
+        }
+        return atlas;
+
+    }
+
+    void Text::Init(const std::string& fontPath, const std::string& fontName, const TextureFiltering& textureFiltering, const bool sdf) {
+        Font font;
+        font.Sdf = sdf;
+        int atlasHeight = 0;
+
+        // Rasterizing 128 glyphs with FreeType is the slow part of startup, the result is kept next to the font
+        const std::string cachePath = fontPath + (sdf ? ".sdf" : "") + ".atlas";
+        const AtlasKey key = MakeAtlasKey(fontPath, sdf);
+        const FileView cache(cachePath);
+        std::vector<unsigned char> rasterized;
+        const unsigned char* atlas = ReadAtlasCache(cache, key, fontPath, atlasWidth, font, atlasHeight);
+        if (atlas == nullptr) {
+            rasterized = RasterizeAtlas(fontPath, sdf, font, atlasHeight);
+            atlas = rasterized.data();
+            if (!WriteAtlasCache(cachePath, key, fontPath, atlasWidth, font, atlasHeight, atlas)) {
+                Logging::Log(1, "Cannot write font cache " + cachePath);
+            }
+        }
+
+        // A distance field is only useful when it is interpolated
+        const bool linear = sdf || textureFiltering == LINEAR;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glGenTextures(1, &font.Atlas);
+        glBindTexture(GL_TEXTURE_2D, font.Atlas);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, atlasWidth, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, atlas);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, linear ? GL_LINEAR : GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, linear ? GL_LINEAR : GL_NEAREST);
         glBindTexture(GL_TEXTURE_2D, 0);
         glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
-        // ----- VAO & VBO ----- //
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, nullptr, GL_DYNAMIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), nullptr);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        if (const auto existing = Fonts.find(fontName); existing != Fonts.end()) {
+            Flush();
+            glDeleteTextures(1, &existing->second.Atlas);
+        }
+        Fonts.insert_or_assign(fontName, font);
+        currentFont = fontName;
 
-        FT_Done_Face(face);
-        FT_Done_FreeType(ft);
+        // ----- VAO & VBO, shared by all fonts ----- //
+        if (VAO == 0) {
+            glGenVertexArrays(1, &VAO);
+            glGenBuffers(1, &VBO);
+            glBindVertexArray(VAO);
+            glBindBuffer(GL_ARRAY_BUFFER, VBO);
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(maxQuads * 6 * sizeof(Vertex)), nullptr, GL_STREAM_DRAW);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, position)));
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, color)));
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            glBindVertexArray(0);
+            vertices.reserve(maxQuads * 6);
+        }
     }
 
     void Text::Use(const std::string& fontName) {
@@ -96,48 +299,67 @@ namespace CPL {
     }
 
     void Text::DrawText(const Shader& shader, const std::string& text, glm::vec2 pos, const float scale, const Color& color) {
-        const glm::mat4 textProjection = glm::ortho(
-         0.0f, static_cast<float>(SCREEN_WIDTH),
-         0.0f, static_cast<float>(SCREEN_HEIGHT)
-        );
-        shader.SetMatrix4fv("projection", textProjection);
-        shader.SetVector3f("textColor", {color.r, color.g, color.b});
-        glActiveTexture(GL_TEXTURE0);
-        glBindVertexArray(VAO);
+        const auto found = Fonts.find(currentFont);
+        if (found == Fonts.end()) return;
+        const Font& font = found->second;
+        if (!vertices.empty() && (font.Atlas != batchAtlas || &shader != batchShader)) Flush();
+        batchShader = &shader;
+        batchAtlas = font.Atlas;
+        batchSdf = font.Sdf;
 
-        for (char c : text) {
-            const auto [TextureID, Size, Bearing, Advance] = Fonts[currentFont].at(c);
+        for (const char c : text) {
+            const auto index = static_cast<unsigned char>(c);
+            if (index >= font.Characters.size()) continue;
+            const auto& [AtlasMin, AtlasMax, Size, Bearing, Advance] = font.Characters[index];
 
             const float xPos = pos.x + static_cast<float>(Bearing.x) * scale;
             const float yPos = pos.y - static_cast<float>((Size.y - Bearing.y)) * scale;
             const float width = static_cast<float>(Size.x) * scale;
             const float height = static_cast<float>(Size.y) * scale;
 
-            const float vertices[6][4] = {
-                { xPos, yPos + height, 0.0f, 0.0f},
-                { xPos, yPos, 0.0f, 1.0f},
-                { xPos + width, yPos, 1.0f, 1.0f},
-
-                { xPos, yPos + height, 0.0f, 0.0f},
-                { xPos + width, yPos, 1.0f, 1.0f},
-                { xPos + width, yPos + height, 1.0f, 0.0f}
-            };
-
-            glBindTexture(GL_TEXTURE_2D, TextureID);
-            glBindBuffer(GL_ARRAY_BUFFER, VBO);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+            // Blank glyphs (space) only advance
+            if (Size.x > 0 && Size.y > 0) {
+                if (vertices.size() + 6 > vertices.capacity()) Flush();
+                vertices.push_back({{xPos, yPos + height}, {AtlasMin.x, AtlasMin.y}, color});
+                vertices.push_back({{xPos, yPos}, {AtlasMin.x, AtlasMax.y}, color});
+                vertices.push_back({{xPos + width, yPos}, {AtlasMax.x, AtlasMax.y}, color});
 
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
+                vertices.push_back({{xPos, yPos + height}, {AtlasMin.x, AtlasMin.y}, color});
+                vertices.push_back({{xPos + width, yPos}, {AtlasMax.x, AtlasMax.y}, color});
+                vertices.push_back({{xPos + width, yPos + height}, {AtlasMax.x, AtlasMin.y}, color});
+            }
 
             pos.x += static_cast<float>(Advance >> 6) * scale;
         }
+    }
+
+    void Text::Flush() {
+        if (vertices.empty()) return;
+
+        batchShader->Use();
+        batchShader->SetBool(Shader::SDF, batchSdf);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, batchAtlas);
+
+        // Orphan, then one upload of every quad since the last flush
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(maxQuads * 6 * sizeof(Vertex)), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex)), vertices.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices.size()));
         glBindVertexArray(0);
         glBindTexture(GL_TEXTURE_2D, 0);
+
+        frameStats.drawCalls++;
+        vertices.clear();
     }
 
     glm::vec2 Text::GetTextSize(const std::string& fontName, const std::string& text, const float scale) {
-        if (!Fonts.contains(fontName)) {
+        const auto found = Fonts.find(fontName);
+        if (found == Fonts.end()) {
             Logging::Log(1, "Cannot find font");
             return glm::vec2(0.0f);
         }
@@ -147,8 +369,10 @@ namespace CPL {
         float maxAboveBaseline = 0.0f;
         float maxBelowBaseline = 0.0f;
 
-        for (char c : text) {
-            const Character& ch = Fonts[fontName].at(c);
+        for (const char c : text) {
+            const auto index = static_cast<unsigned char>(c);
+            if (index >= found->second.Characters.size()) continue;
+            const Character& ch = found->second.Characters[index];
             const float h = static_cast<float>(ch.Size.y) * scale;
             maxAboveBaseline = std::max(maxAboveBaseline, static_cast<float>(ch.Bearing.y) * scale);
             maxBelowBaseline = std::max(maxBelowBaseline, (h - static_cast<float>(ch.Bearing.y) * scale));
@@ -157,4 +381,4 @@ namespace CPL {
         height = maxAboveBaseline + maxBelowBaseline;
         return {width, height};
     }
-}
\ No newline at end of file
+}
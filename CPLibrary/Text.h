@@ -1,28 +1,61 @@
 #pragma once
+#include <array>
 #include <map>
 #include <string>
+#include <vector>
 #include <glm/glm.hpp>
 #include "glad/glad.h"
 #include "CPL.h"
 
 namespace CPL {
     struct Character {
-        unsigned int TextureID;
+        // Texture coordinates of the glyph in the font atlas
+        glm::vec2 AtlasMin;
+        glm::vec2 AtlasMax;
         glm::ivec2 Size;
         glm::ivec2 Bearing;
         unsigned int Advance;
     };
 
+    // All ASCII glyphs of one font packed into a single texture. A signed distance field atlas stays sharp
+    // at any scale, the plain one is the coverage bitmap.
+    struct Font {
+        unsigned int Atlas = 0;
+        bool Sdf = false;
+        std::array<Character, 128> Characters{};
+    };
+
+    // DrawText only appends quads, the text of a scope is drawn with one call at BeginDrawing, EndDrawing
+    // or when the font changes
     class Text {
     public:
-        static std::map<std::string, std::map<GLchar, Character>> Fonts;
+        static std::map<std::string, Font> Fonts;
 
-        static void Init(const std::string& fontPath, const std::string& fontName, const TextureFiltering& textureFiltering);
+        static void Init(const std::string& fontPath, const std::string& fontName, const TextureFiltering& textureFiltering, bool sdf = false);
         static void Use(const std::string& fontName);
         static void DrawText(const Shader& shader, const std::string& text, glm::vec2 pos, float scale, const Color& color);
+        static void Flush();
         static glm::vec2 GetTextSize(const std::string& fontName, const std::string& text, float scale);
+
+        static constexpr int pixelSize = 48;
+        static constexpr int atlasWidth = 512;
     private:
+        // Packs the glyphs of the font into an atlasWidth wide atlas and fills their metrics
+        static std::vector<unsigned char> RasterizeAtlas(const std::string& fontPath, bool sdf, Font& font, int& atlasHeight);
+
+        struct Vertex {
+            glm::vec2 position;
+            glm::vec2 texture;
+            Color color;
+        };
+
+        static constexpr int maxQuads = 4096;
+
         static unsigned int VAO, VBO;
         static std::string currentFont;
+        static std::vector<Vertex> vertices;
+        static const Shader* batchShader;
+        static unsigned int batchAtlas;
+        static bool batchSdf;
     };
-}
\ No newline at end of file
+}
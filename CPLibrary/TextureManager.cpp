@@ -0,0 +1,225 @@
+#include "TextureManager.h"
+#include "Logging.h"
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+namespace CPL {
+    std::vector<TextureManager::Entry> TextureManager::entries;
+    std::vector<int> TextureManager::freeSlots;
+    std::unordered_map<std::string, int> TextureManager::byPath;
+    std::deque<TextureManager::Decoded> TextureManager::uploads;
+    std::mutex TextureManager::mutex;
+    std::condition_variable TextureManager::jobAdded;
+    std::deque<TextureManager::Job> TextureManager::jobs;
+    std::vector<TextureManager::Decoded> TextureManager::decoded;
+    bool TextureManager::stopping = false;
+    std::thread TextureManager::worker;
+    unsigned int TextureManager::PBO = 0;
+
+    void TextureManager::Init() {
+        glGenBuffers(1, &PBO);
+        stopping = false;
+        worker = std::thread(Decode);
+    }
+
+    void TextureManager::Close() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+            jobs.clear();
+        }
+        jobAdded.notify_one();
+        if (worker.joinable()) worker.join();
+
+        for (const Decoded& image : decoded) stbi_image_free(image.pixels);
+        for (const Decoded& image : uploads) stbi_image_free(image.pixels);
+        decoded.clear();
+        uploads.clear();
+        for (const Entry& entry : entries) {
+            if (entry.texture != 0) glDeleteTextures(1, &entry.texture);
+        }
+        entries.clear();
+        freeSlots.clear();
+        byPath.clear();
+        if (PBO != 0) glDeleteBuffers(1, &PBO);
+        PBO = 0;
+    }
+
+    TextureManager::Handle TextureManager::Load(const std::string& path, const TextureFiltering textureFiltering) {
+        // "assets/./a.png" and "assets/a.png" share one texture
+        const std::string key = std::filesystem::path(path).lexically_normal().generic_string();
+        if (const auto found = byPath.find(key); found != byPath.end()) {
+            Entry& entry = entries[found->second];
+            entry.references++;
+            return {found->second, entry.generation};
+        }
+
+        int index;
+        if (!freeSlots.empty()) {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            index = static_cast<int>(entries.size());
+            entries.emplace_back();
+        }
+        Entry& entry = entries[index];
+        const unsigned int generation = entry.generation;
+        entry = {key, textureFiltering, LOADING, 1, generation, 0, {0, 0}};
+        byPath.emplace(key, index);
+        {
+            std::lock_guard lock(mutex);
+            jobs.push_back({index, generation, key});
+        }
+        jobAdded.notify_one();
+        return {index, generation};
+    }
+
+    void TextureManager::Release(const Handle handle) {
+        Entry* entry = Find(handle);
+        if (entry == nullptr || --entry->references > 0) return;
+        {
+            // A queued decode is dropped here, one already running is dropped by Update since the generation no longer matches
+            std::lock_guard lock(mutex);
+            std::erase_if(jobs, [handle](const Job& job) { return job.index == handle.index && job.generation == handle.generation; });
+        }
+        if (entry->texture != 0) glDeleteTextures(1, &entry->texture);
+        byPath.erase(entry->path);
+        const unsigned int generation = entry->generation + 1;
+        *entry = {};
+        entry->generation = generation;
+        freeSlots.push_back(handle.index);
+    }
+
+    void TextureManager::Update() {
+        {
+            std::lock_guard lock(mutex);
+            if (!decoded.empty()) {
+                uploads.insert(uploads.end(), decoded.begin(), decoded.end());
+                decoded.clear();
+            }
+        }
+
+        long long uploaded = 0;
+        while (!uploads.empty() && (uploaded == 0 || uploaded < uploadBudget)) {
+            const Decoded image = uploads.front();
+            uploads.pop_front();
+            Entry* entry = Find({image.index, image.generation});
+            if (entry == nullptr) {
+                stbi_image_free(image.pixels);
+                continue;
+            }
+            if (image.pixels == nullptr) {
+                entry->state = FAILED;
+                Logging::Log(2, "Failed to load texture: " + entry->path);
+                continue;
+            }
+            Upload(*entry, image);
+            uploaded += static_cast<long long>(image.size.x) * image.size.y * image.channels;
+            stbi_image_free(image.pixels);
+            RequestRedraw();
+        }
+    }
+
+    void TextureManager::Upload(Entry& entry, const Decoded& image) {
+        GLenum format = GL_RGBA;
+        if (image.channels == 1) format = GL_RED;
+        else if (image.channels == 2) format = GL_RG;
+        else if (image.channels == 3) format = GL_RGB;
+        const auto bytes = static_cast<GLsizeiptr>(image.size.x) * image.size.y * image.channels;
+
+        // Orphaned every time, so the copy never waits for the previous upload that may still read the buffer.
+        // glTexImage2D then sources the buffer and returns without waiting for the transfer.
+        const void* source = nullptr;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        if (void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT)) {
+            std::memcpy(mapped, image.pixels, bytes);
+            if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                source = image.pixels;
+            }
+        }
+        else {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            source = image.pixels;
+        }
+
+        const GLint filter = entry.filtering == LINEAR ? GL_LINEAR : GL_NEAREST;
+        glGenTextures(1, &entry.texture);
+        glBindTexture(GL_TEXTURE_2D, entry.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+        glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(format), image.size.x, image.size.y, 0, format, GL_UNSIGNED_BYTE, source);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        entry.size = image.size;
+        entry.state = READY;
+    }
+
+    void TextureManager::Decode() {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock lock(mutex);
+                jobAdded.wait(lock, [] { return stopping || !jobs.empty(); });
+                if (stopping) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            Decoded image{job.index, job.generation, nullptr, {0, 0}, 0};
+            image.pixels = stbi_load(job.path.c_str(), &image.size.x, &image.size.y, &image.channels, 0);
+            if (image.pixels != nullptr) {
+                // Bottom row first like GL expects. Flipped here instead of through stb's global flag, which
+                // is shared with every other stbi_load of the program.
+                const size_t rowBytes = static_cast<size_t>(image.size.x) * image.channels;
+                std::vector<unsigned char> row(rowBytes);
+                for (int top = 0, bottom = image.size.y - 1; top < bottom; top++, bottom--) {
+                    unsigned char* a = image.pixels + top * rowBytes;
+                    unsigned char* b = image.pixels + bottom * rowBytes;
+                    std::memcpy(row.data(), a, rowBytes);
+                    std::memcpy(a, b, rowBytes);
+                    std::memcpy(b, row.data(), rowBytes);
+                }
+            }
+
+            std::lock_guard lock(mutex);
+            decoded.push_back(image);
+        }
+    }
+
+    TextureManager::Entry* TextureManager::Find(const Handle handle) {
+        if (handle.index < 0 || handle.index >= static_cast<int>(entries.size())) return nullptr;
+        Entry& entry = entries[handle.index];
+        if (entry.generation != handle.generation || entry.references <= 0) return nullptr;
+        return &entry;
+    }
+
+    unsigned int TextureManager::GetTexture(const Handle handle) {
+        const Entry* entry = Find(handle);
+        return entry == nullptr ? 0 : entry->texture;
+    }
+
+    bool TextureManager::IsReady(const Handle handle) {
+        const Entry* entry = Find(handle);
+        return entry != nullptr && entry->state == READY;
+    }
+
+    glm::vec2 TextureManager::GetSize(const Handle handle) {
+        const Entry* entry = Find(handle);
+        return entry == nullptr ? glm::vec2(0.0f) : glm::vec2(entry->size.x, entry->size.y);
+    }
+
+    int TextureManager::Pending() {
+        return static_cast<int>(std::ranges::count_if(entries, [](const Entry& entry) {
+            return entry.references > 0 && entry.state == LOADING;
+        }));
+    }
+}
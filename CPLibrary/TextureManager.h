@@ -0,0 +1,89 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "CPL.h"
+
+namespace CPL {
+    // Owns every texture loaded from a file. A path is decoded once (stb, on a worker thread) and shared by all
+    // handles to it, Update uploads the decoded images on the render thread through a pixel buffer object.
+    // A handle stays valid until every Load of its path was released; texture 0 is returned until the upload.
+    class TextureManager {
+    public:
+        struct Handle {
+            int index = -1;
+            unsigned int generation = 0;
+        };
+
+        static void Init();
+        static void Close();
+        // Returns right away, the first Load of a path queues the decode. The filtering of the first Load is kept.
+        static Handle Load(const std::string& path, TextureFiltering textureFiltering = LINEAR);
+        static void Release(Handle handle);
+        // Render thread, once per frame: uploads decoded images until uploadBudget bytes were copied
+        static void Update();
+
+        [[nodiscard]] static unsigned int GetTexture(Handle handle);
+        [[nodiscard]] static bool IsReady(Handle handle);
+        // Image size in pixels, 0 until uploaded
+        [[nodiscard]] static glm::vec2 GetSize(Handle handle);
+        // Loads that are still decoding or waiting for their upload
+        [[nodiscard]] static int Pending();
+
+        // At least one image is uploaded per frame even when it is larger
+        static constexpr long long uploadBudget = 8ll << 20;
+    private:
+        enum State {
+            LOADING,
+            READY,
+            FAILED,
+        };
+        struct Entry {
+            std::string path;
+            TextureFiltering filtering = LINEAR;
+            State state = LOADING;
+            int references = 0;
+            unsigned int generation = 0;
+            unsigned int texture = 0;
+            glm::ivec2 size{0, 0};
+        };
+
+        struct Job {
+            int index;
+            unsigned int generation;
+            std::string path;
+        };
+        // pixels is stb owned, nullptr when the file could not be decoded
+        struct Decoded {
+            int index;
+            unsigned int generation;
+            unsigned char* pixels;
+            glm::ivec2 size;
+            int channels;
+        };
+
+        static Entry* Find(Handle handle);
+        static void Decode();
+        static void Upload(Entry& entry, const Decoded& image);
+
+        // entries, freeSlots, byPath and uploads belong to the render thread, the worker only sees jobs and decoded
+        static std::vector<Entry> entries;
+        static std::vector<int> freeSlots;
+        static std::unordered_map<std::string, int> byPath;
+        static std::deque<Decoded> uploads;
+
+        static std::mutex mutex;
+        static std::condition_variable jobAdded;
+        static std::deque<Job> jobs;
+        static std::vector<Decoded> decoded;
+        static bool stopping;
+        static std::thread worker;
+
+        static unsigned int PBO;
+    };
+}
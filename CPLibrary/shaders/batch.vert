@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec2 aPos;             // unit shape, centered on the pivot
+layout (location = 1) in vec4 instanceRect;     // pivot xy, size xy
+layout (location = 2) in vec4 instanceColor;    // 0-255
+layout (location = 3) in float instanceRotation; // radians
+out vec4 shapeColor;
+
+// Shared by every program, written by BeginDrawing (projection) and InitWindow (textProjection)
+layout (std140) uniform Matrices {
+    mat4 projection;
+    mat4 textProjection;
+};
+
+void main() {
+    vec2 local = aPos * instanceRect.zw;
+    float c = cos(instanceRotation);
+    float s = sin(instanceRotation);
+    vec2 rotated = vec2(c * local.x - s * local.y, s * local.x + c * local.y);
+    gl_Position = projection * vec4(instanceRect.xy + rotated, 0.0, 1.0);
+    shapeColor = instanceColor / 255.0;
+}
@@ -1,7 +1,11 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 projection;
+// Shared by every program, written by BeginDrawing (projection) and InitWindow (textProjection)
+layout (std140) uniform Matrices {
+    mat4 projection;
+    mat4 textProjection;
+};
 uniform vec3 offset;
 uniform mat4 transform;
 
@@ -1,11 +1,18 @@
 #version 330 core
 in vec2 TexCoords;
+in vec4 TextColor;
 out vec4 color;
 
 uniform sampler2D text;
-uniform vec3 textColor;
+uniform bool sdf;
 
 void main() {
-    vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoords).r);
-    color = vec4(textColor / 255.0, 1.0) * sampled;
-}
\ No newline at end of file
+    float value = texture(text, TexCoords).r;
+    float alpha = value;
+    if (sdf) {
+        // 0.5 is the outline, the smoothing band is about one screen pixel wide at any scale
+        float width = max(fwidth(value), 1e-4);
+        alpha = smoothstep(0.5 - width, 0.5 + width, value);
+    }
+    color = vec4(TextColor.rgb, TextColor.a * alpha);
+}
@@ -1,10 +1,17 @@
 #version 330 core
 layout (location = 0) in vec4 vertex; // vec2 pos + vec2 tex
+layout (location = 1) in vec4 vertexColor; // 0-255
 out vec2 TexCoords;
+out vec4 TextColor;
 
-uniform mat4 projection;
+// Shared by every program, written by BeginDrawing (projection) and InitWindow (textProjection)
+layout (std140) uniform Matrices {
+    mat4 projection;
+    mat4 textProjection;
+};
 
 void main() {
-    gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
+    gl_Position = textProjection * vec4(vertex.xy, 0.0, 1.0);
     TexCoords = vertex.zw;
-}
\ No newline at end of file
+    TextColor = vertexColor / 255.0;
+}
@@ -4,7 +4,11 @@ layout (location = 1) in vec2 aTexCoord;
 
 out vec2 TexCoord;
 
-uniform mat4 projection;
+// Shared by every program, written by BeginDrawing (projection) and InitWindow (textProjection)
+layout (std140) uniform Matrices {
+    mat4 projection;
+    mat4 textProjection;
+};
 uniform vec3 offset;
 uniform mat4 transform;
 
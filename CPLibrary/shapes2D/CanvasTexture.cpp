@@ -0,0 +1,148 @@
+#include "CanvasTexture.h"
+#include "../Shader.h"
+#include "../ShapeBatch.h"
+
+#include <algorithm>
+
+namespace CPL {
+    namespace {
+        unsigned char ToByte(const float value) {
+            return static_cast<unsigned char>(std::clamp(value, 0.0f, 255.0f));
+        }
+
+        // Unit square from the top left corner, row 0 of the texture at the top
+        glm::mat4 QuadTransform(const glm::vec2 position, const glm::vec2 size) {
+            auto transform = glm::mat4(1.0f);
+            transform = glm::translate(transform, glm::vec3(position, 0.0f));
+            transform = glm::scale(transform, glm::vec3(size, 1.0f));
+            return transform;
+        }
+    }
+
+    CanvasTexture::CanvasTexture(const int columns, const int rows)
+        : columns(columns), rows(rows), pixels(static_cast<size_t>(columns) * rows * 4, 0), dirtyTop(rows), dirtyBottom(-1) {
+        constexpr float vertices[] = {
+            // positions        // texture coords
+            0.0f, 0.0f, 0.0f,   0.0f, 0.0f, // top left
+            1.0f, 0.0f, 0.0f,   1.0f, 0.0f, // top right
+            1.0f, 1.0f, 0.0f,   1.0f, 1.0f, // bottom right
+            0.0f, 0.0f, 0.0f,   0.0f, 0.0f, // top left
+            1.0f, 1.0f, 0.0f,   1.0f, 1.0f, // bottom right
+            0.0f, 1.0f, 0.0f,   0.0f, 1.0f  // bottom left
+        };
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        // Position
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), static_cast<void*>(nullptr));
+        glEnableVertexAttribArray(0);
+        // Texture coordinates
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), reinterpret_cast<void*>(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        // ----- Grid lines, built once in unit coordinates ----- //
+        std::vector<float> grid;
+        for (int x = 0; x <= columns; x++) {
+            const float u = static_cast<float>(x) / static_cast<float>(columns);
+            grid.insert(grid.end(), {u, 0.0f, 0.0f, u, 1.0f, 0.0f});
+        }
+        for (int y = 0; y <= rows; y++) {
+            const float v = static_cast<float>(y) / static_cast<float>(rows);
+            grid.insert(grid.end(), {0.0f, v, 0.0f, 1.0f, v, 0.0f});
+        }
+        gridVertexCount = static_cast<int>(grid.size()) / 3;
+        glGenVertexArrays(1, &gridVAO);
+        glGenBuffers(1, &gridVBO);
+        glBindVertexArray(gridVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, gridVBO);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(grid.size() * sizeof(float)), grid.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), static_cast<void*>(nullptr));
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, columns, rows, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void CanvasTexture::SetPixel(const int x, const int y, const Color& color) {
+        if (x < 0 || x >= columns || y < 0 || y >= rows) return;
+        unsigned char* pixel = pixels.data() + (static_cast<size_t>(y) * columns + x) * 4;
+        const unsigned char rgba[4] = {ToByte(color.r), ToByte(color.g), ToByte(color.b), ToByte(color.a)};
+        if (std::equal(rgba, rgba + 4, pixel)) return;
+        std::copy_n(rgba, 4, pixel);
+        dirtyTop = std::min(dirtyTop, y);
+        dirtyBottom = std::max(dirtyBottom, y);
+    }
+
+    void CanvasTexture::Fill(const Color& color) {
+        for (int y = 0; y < rows; y++) {
+            for (int x = 0; x < columns; x++) {
+                SetPixel(x, y, color);
+            }
+        }
+    }
+
+    void CanvasTexture::Upload() {
+        if (dirtyTop > dirtyBottom) return;
+        // Rows are tightly packed, so the dirty span is one contiguous block
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, dirtyTop, columns, dirtyBottom - dirtyTop + 1, GL_RGBA, GL_UNSIGNED_BYTE,
+                        pixels.data() + static_cast<size_t>(dirtyTop) * columns * 4);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        dirtyTop = rows;
+        dirtyBottom = -1;
+    }
+
+    void CanvasTexture::Draw(const Shader& shader, const glm::vec2 position, const glm::vec2 size, const Color& color) {
+        ShapeBatch::Flush();
+        Upload();
+
+        shader.SetMatrix4fv(Shader::TRANSFORM, QuadTransform(position, size));
+        shader.SetVector3f(Shader::OFFSET, glm::vec3(0.0f));
+        shader.SetColor(Shader::INPUT_COLOR, color);
+
+        // Cells can be translucent (heat map), whatever blend state the previous scope left
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glBindVertexArray(VAO);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        frameStats.drawCalls++;
+    }
+
+    void CanvasTexture::DrawGrid(const Shader& shader, const glm::vec2 position, const glm::vec2 size, const Color& color) const {
+        ShapeBatch::Flush();
+        shader.SetMatrix4fv(Shader::TRANSFORM, QuadTransform(position, size));
+        shader.SetVector3f(Shader::OFFSET, glm::vec3(0.0f));
+        shader.SetColor(Shader::INPUT_COLOR, color);
+        glBindVertexArray(gridVAO);
+        glDrawArrays(GL_LINES, 0, gridVertexCount);
+        glBindVertexArray(0);
+        frameStats.drawCalls++;
+    }
+
+    void CanvasTexture::Unload() const {
+        if (texture != 0)
+            glDeleteTextures(1, &texture);
+        if (VAO != 0)
+            glDeleteVertexArrays(1, &VAO);
+        if (VBO != 0)
+            glDeleteBuffers(1, &VBO);
+        if (gridVAO != 0)
+            glDeleteVertexArrays(1, &gridVAO);
+        if (gridVBO != 0)
+            glDeleteBuffers(1, &gridVBO);
+    }
+}
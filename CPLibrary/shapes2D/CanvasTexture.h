@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include "../CPL.h"
+
+namespace CPL {
+    struct Color;
+    class Shader;
+
+    // Grid of colored cells kept as a small RGBA texture. SetPixel only touches the CPU copy and marks the row dirty,
+    // Upload sends the dirty rows with one glTexSubImage2D. Draw is a single nearest filtered quad and DrawGrid one
+    // cached line buffer, so the cost does not depend on how many cells are filled.
+    class CanvasTexture {
+    public:
+        CanvasTexture(int columns, int rows);
+
+        void SetPixel(int x, int y, const Color& color);
+        void Fill(const Color& color);
+        // Called by Draw, only needed to upload early
+        void Upload();
+        // Texture shader, cells are stretched over size and multiplied with color
+        void Draw(const Shader& shader, glm::vec2 position, glm::vec2 size, const Color& color);
+        // Shape shader, lines between and around the cells
+        void DrawGrid(const Shader& shader, glm::vec2 position, glm::vec2 size, const Color& color) const;
+        void Unload() const;
+
+        [[nodiscard]] int Columns() const { return columns; }
+        [[nodiscard]] int Rows() const { return rows; }
+    private:
+        int columns;
+        int rows;
+        std::vector<unsigned char> pixels;
+        // Rows changed since the last upload, none when dirtyTop > dirtyBottom
+        int dirtyTop;
+        int dirtyBottom;
+        int gridVertexCount = 0;
+        unsigned int VBO{}, VAO{};
+        unsigned int gridVBO{}, gridVAO{};
+        unsigned int texture{};
+    };
+}
@@ -68,9 +68,9 @@ namespace CPL {
         transform = glm::rotate(transform, -glm::radians(rotationAngle), glm::vec3(0.0f, 0.0f, 1.0f));
         transform = glm::translate(transform, glm::vec3(-center, 0.0f));
 
-        shader.SetMatrix4fv("transform", transform);
-        shader.SetVector3f("offset", glm::vec3(position, 0.0f));
-        shader.SetColor("inputColor", color);
+        shader.SetMatrix4fv(Shader::TRANSFORM, transform);
+        shader.SetVector3f(Shader::OFFSET, glm::vec3(position, 0.0f));
+        shader.SetColor(Shader::INPUT_COLOR, color);
 
         glBindVertexArray(VAO);
         glDrawArrays(GL_TRIANGLE_FAN, 0, vertexCount);
@@ -84,9 +84,9 @@ namespace CPL {
         transform = glm::rotate(transform, -glm::radians(rotationAngle), glm::vec3(0.0f, 0.0f, 1.0f));
         transform = glm::translate(transform, glm::vec3(-center, 0.0f));
 
-        shader.SetMatrix4fv("transform", transform);
-        shader.SetVector3f("offset", glm::vec3(position, 0.0f));
-        shader.SetColor("inputColor", color);
+        shader.SetMatrix4fv(Shader::TRANSFORM, transform);
+        shader.SetVector3f(Shader::OFFSET, glm::vec3(position, 0.0f));
+        shader.SetColor(Shader::INPUT_COLOR, color);
 
         glBindVertexArray(outlineVAO);
         glDrawArrays(GL_LINE_LOOP, 0, vertexCount - 1);
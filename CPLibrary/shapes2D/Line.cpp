@@ -32,9 +32,9 @@ namespace CPL {
 
 
     void Line::Draw(const Shader& shader) const {
-        shader.SetMatrix4fv("transform", glm::mat4(1.0f));
-        shader.SetVector3f("offset", glm::vec3(0.0f));
-        shader.SetColor("inputColor", color);
+        shader.SetMatrix4fv(Shader::TRANSFORM, glm::mat4(1.0f));
+        shader.SetVector3f(Shader::OFFSET, glm::vec3(0.0f));
+        shader.SetColor(Shader::INPUT_COLOR, color);
         glBindVertexArray(VAO);
         glDrawArrays(GL_LINES, 0, 2);
         glBindVertexArray(0);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../CPL.h"
+#include "../TextureManager.h"
 
 namespace CPL {
     struct Color;
@@ -11,16 +12,24 @@ namespace CPL {
         glm::vec2 position;
         glm::vec2 size;
         glm::vec2 textureSize;
-        int channels{};
         float rotationAngle = 0;
         Color color;
 
+        // The image is shared with every other Texture2D of the same path and loads in the background through
+        // TextureManager, nothing is drawn until it was uploaded. size is the drawn size, not the image size.
         explicit Texture2D(const std::string& filePath, glm::vec2 size, const TextureFiltering& textureFiltering);
         Texture2D(const std::string& filePath, glm::vec2 position, glm::vec2 size, const Color& color, const TextureFiltering& textureFiltering);
         void Draw(const Shader& shader) const;
+        void Draw(const Shader& shader, glm::vec2 position, float rotationAngle, const Color& color) const;
         void Unload() const;
+
+        [[nodiscard]] bool IsReady() const { return TextureManager::IsReady(handle); }
+        // Pixels of the image file, 0 until it was uploaded
+        [[nodiscard]] glm::vec2 GetImageSize() const { return TextureManager::GetSize(handle); }
     private:
+        void CreateQuad();
+
         unsigned int VBO{}, VAO{}, EBO{};
-        unsigned int texture{};
+        TextureManager::Handle handle;
     };
 }
\ No newline at end of file
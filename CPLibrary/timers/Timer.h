@@ -15,8 +15,9 @@ namespace CPL {
         Timer(const float time, const bool repeat, std::function<void()> cb)
             : duration(time), loop(repeat), callback(std::move(cb)) {}
 
-        void Update(const float delta) {
-            if (finished || paused) return;
+        // True when the callback ran
+        bool Update(const float delta) {
+            if (finished || paused) return false;
             elapsed += delta;
             if (elapsed >= duration) {
                 callback();
@@ -25,7 +26,9 @@ namespace CPL {
                 } else {
                     finished = true;
                 }
+                return true;
             }
+            return false;
         }
 
         void Pause() { paused = true; }
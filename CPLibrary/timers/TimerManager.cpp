@@ -1,12 +1,28 @@
 #include "TimerManager.h"
 
+#include <algorithm>
+
 namespace CPL {
     std::vector<Timer> TimerManager::timers{};
 
     void TimerManager::Update(const float delta) {
-        for (auto& t : timers) t.Update(delta);
+        bool fired = false;
+        for (auto& t : timers) fired |= t.Update(delta);
         std::erase_if(timers,
                     [](auto& t){ return t.finished; });
+        // Callbacks change what is on screen
+        if (fired) RequestRedraw();
+    }
+
+    float TimerManager::TimeUntilNext() {
+        if (timeScale <= 0.0f) return -1.0f;
+        float next = -1.0f;
+        for (const auto& t : timers) {
+            if (t.finished || t.paused) continue;
+            const float remaining = std::max(0.0f, t.duration - t.elapsed) / timeScale;
+            if (next < 0.0f || remaining < next) next = remaining;
+        }
+        return next;
     }
 
     void TimerManager::AddTimer(float duration, bool loop, const std::function<void()>& cb) {
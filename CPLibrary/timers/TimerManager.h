@@ -10,6 +10,8 @@ namespace CPL {
     class TimerManager {
     public:
         static void Update(float delta);
+        // Real seconds until the next running timer fires, a negative value when none is running
+        static float TimeUntilNext();
         static void AddTimer(float duration, bool loop, const std::function<void()>& cb);
         static void StopTimers();
         static void ClearTimers();
@@ -0,0 +1,103 @@
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    // Trivially constructible so operator new can use it before any static initialization ran
+    thread_local AllocationTracker::Counts threadCounts;
+    std::atomic<std::uint64_t> processAllocations = 0;
+    std::atomic<std::uint64_t> processDeallocations = 0;
+    std::atomic<std::uint64_t> processBytes = 0;
+}
+
+AllocationTracker::Counts AllocationTracker::Thread() {
+    return threadCounts;
+}
+
+AllocationTracker::Counts AllocationTracker::Process() {
+    return {processAllocations.load(std::memory_order_relaxed), processDeallocations.load(std::memory_order_relaxed),
+            processBytes.load(std::memory_order_relaxed)};
+}
+
+#ifdef DIGITNET_TRACK_ALLOCATIONS
+namespace {
+    void CountAllocation(const std::size_t size) {
+        threadCounts.allocations++;
+        threadCounts.bytes += size;
+        processAllocations.fetch_add(1, std::memory_order_relaxed);
+        processBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    void CountDeallocation(const void* pointer) {
+        if (pointer == nullptr) return;
+        threadCounts.deallocations++;
+        processDeallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void* Allocate(const std::size_t size) {
+        CountAllocation(size);
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void* AllocateAligned(const std::size_t size, const std::align_val_t alignment) {
+        CountAllocation(size);
+        const auto align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+        return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+        // aligned_alloc wants the size to be a multiple of the alignment
+        return std::aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+    }
+
+    void Free(void* pointer) {
+        CountDeallocation(pointer);
+        std::free(pointer);
+    }
+
+    void FreeAligned(void* pointer) {
+        CountDeallocation(pointer);
+#ifdef _WIN32
+        _aligned_free(pointer);
+#else
+        std::free(pointer);
+#endif
+    }
+}
+
+void* operator new(const std::size_t size) {
+    if (void* pointer = Allocate(size)) return pointer;
+    throw std::bad_alloc();
+}
+void* operator new[](const std::size_t size) {
+    if (void* pointer = Allocate(size)) return pointer;
+    throw std::bad_alloc();
+}
+void* operator new(const std::size_t size, const std::nothrow_t&) noexcept { return Allocate(size); }
+void* operator new[](const std::size_t size, const std::nothrow_t&) noexcept { return Allocate(size); }
+void* operator new(const std::size_t size, const std::align_val_t alignment) {
+    if (void* pointer = AllocateAligned(size, alignment)) return pointer;
+    throw std::bad_alloc();
+}
+void* operator new[](const std::size_t size, const std::align_val_t alignment) {
+    if (void* pointer = AllocateAligned(size, alignment)) return pointer;
+    throw std::bad_alloc();
+}
+void* operator new(const std::size_t size, const std::align_val_t alignment, const std::nothrow_t&) noexcept { return AllocateAligned(size, alignment); }
+void* operator new[](const std::size_t size, const std::align_val_t alignment, const std::nothrow_t&) noexcept { return AllocateAligned(size, alignment); }
+
+void operator delete(void* pointer) noexcept { Free(pointer); }
+void operator delete[](void* pointer) noexcept { Free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { Free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { Free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { Free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { Free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { FreeAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { FreeAligned(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { FreeAligned(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { FreeAligned(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(pointer); }
+#endif
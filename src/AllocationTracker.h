@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+
+// Counts every global operator new/delete when built with -DDIGITNET_TRACK_ALLOCATIONS (CMake option
+// DIGITNET_TRACK_ALLOCATIONS), per thread and for the whole process. Profiling zones record the allocations
+// of their thread, "alloccheck" uses the counts to verify that inference and training steps do not allocate.
+class AllocationTracker {
+public:
+#ifdef DIGITNET_TRACK_ALLOCATIONS
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+    struct Counts {
+        std::uint64_t allocations = 0;
+        std::uint64_t deallocations = 0;
+        std::uint64_t bytes = 0;
+
+        Counts operator-(const Counts& other) const {
+            return {allocations - other.allocations, deallocations - other.deallocations, bytes - other.bytes};
+        }
+    };
+
+    // Calling thread only, all zero when tracking is compiled out
+    [[nodiscard]] static Counts Thread();
+    // All threads, including the ones that already exited
+    [[nodiscard]] static Counts Process();
+};
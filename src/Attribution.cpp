@@ -0,0 +1,83 @@
+#include "Attribution.h"
+#include "NeuralNetwork.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Min-max scaling to 0-1, a flat map becomes all zero
+    void ScaleToUnit(const float* values, const int count, float* output) {
+        const auto [minValue, maxValue] = std::minmax_element(values, values + count);
+        const float low = *minValue;
+        const float range = *maxValue - low;
+        const float scale = range < 1e-12f ? 0.0f : 1.0f / range;
+        for (int i = 0; i < count; i++) {
+            output[i] = (values[i] - low) * scale;
+        }
+    }
+}
+
+Attribution::Attribution(const NeuralNetwork& network)
+    : network(network), inputSize(network.inputSize), hiddenSize(network.hiddenSize), outputSize(network.outputSize),
+      hidden(hiddenSize), outputs(outputSize), classFactors(static_cast<size_t>(outputSize) * hiddenSize),
+      relevance(static_cast<size_t>(outputSize) * inputSize), heatMap(inputSize) {}
+
+const float* Attribution::Relevance(const int outputIndex) const {
+    return relevance.data() + static_cast<size_t>(outputIndex) * inputSize;
+}
+
+void Attribution::NormalizedRelevance(const int outputIndex, float* output) const {
+    ScaleToUnit(Relevance(outputIndex), inputSize, output);
+}
+
+void Attribution::Compute(const float* input) {
+    PROFILE_ZONE("attribution");
+
+    // Forward pass, the hidden vector feeds both the class factors and the heat map
+    for (int h = 0; h < hiddenSize; h++) {
+        const float* weights = network.W1[h].data();
+        float sum = network.b1[h];
+        for (int i = 0; i < inputSize; i++) {
+            sum += weights[i] * input[i];
+        }
+        hidden[h] = NeuralNetwork::sigmoid(sum);
+    }
+    for (int o = 0; o < outputSize; o++) {
+        float sum = network.b2[o];
+        for (int h = 0; h < hiddenSize; h++) {
+            sum += network.W2[o][h] * hidden[h];
+        }
+        outputs[o] = NeuralNetwork::sigmoid(sum);
+    }
+    prediction = static_cast<int>(std::ranges::max_element(outputs) - outputs.begin());
+
+    // Backward through the output and hidden sigmoids, for every class at once
+    for (int o = 0; o < outputSize; o++) {
+        const float outputDerivative = NeuralNetwork::sigmoidDerivative(outputs[o]);
+        for (int h = 0; h < hiddenSize; h++) {
+            classFactors[static_cast<size_t>(o) * hiddenSize + h] =
+                outputDerivative * network.W2[o][h] * NeuralNetwork::sigmoidDerivative(hidden[h]);
+        }
+    }
+
+    // relevance = classFactors x W1 with the W1 row as the outer loop, so each row is streamed once and
+    // updates all outputSize relevance rows (small enough to stay in cache) and the heat map
+    std::ranges::fill(relevance, 0.0f);
+    std::ranges::fill(heatMap, 0.0f);
+    for (int h = 0; h < hiddenSize; h++) {
+        const float* weights = network.W1[h].data();
+        const float activation = hidden[h];
+        for (int i = 0; i < inputSize; i++) {
+            heatMap[i] += std::abs(weights[i]) * activation;
+        }
+        for (int o = 0; o < outputSize; o++) {
+            const float factor = classFactors[static_cast<size_t>(o) * hiddenSize + h];
+            float* row = relevance.data() + static_cast<size_t>(o) * inputSize;
+            for (int i = 0; i < inputSize; i++) {
+                row[i] += factor * weights[i];
+            }
+        }
+    }
+    ScaleToUnit(heatMap.data(), inputSize, heatMap.data());
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+
+class NeuralNetwork;
+
+// Input attributions of every class from one forward pass. The relevance of class o is the input gradient
+// d output_o / d input, computed for all classes as one (outputSize x hiddenSize) by (hiddenSize x inputSize)
+// product that reads W1 once. The activation heat map (sum over h of |W1[h][i]| * hidden[h]) comes from the same
+// cached hidden vector. Buffers are sized once, Compute does not allocate.
+class Attribution {
+public:
+    explicit Attribution(const NeuralNetwork& network);
+
+    // input holds inputSize floats
+    void Compute(const float* input);
+
+    [[nodiscard]] const std::vector<float>& Outputs() const { return outputs; }
+    [[nodiscard]] int Prediction() const { return prediction; }
+    // outputSize x inputSize, row o is the raw relevance of class o
+    [[nodiscard]] const std::vector<float>& Relevances() const { return relevance; }
+    [[nodiscard]] const float* Relevance(int outputIndex) const;
+    // Relevance of one class scaled to 0-1, output holds inputSize floats
+    void NormalizedRelevance(int outputIndex, float* output) const;
+    // inputSize values scaled to 0-1
+    [[nodiscard]] const std::vector<float>& HeatMap() const { return heatMap; }
+private:
+    const NeuralNetwork& network;
+    int inputSize;
+    int hiddenSize;
+    int outputSize;
+
+    std::vector<float> hidden;
+    std::vector<float> outputs;
+    // classFactors[o * hiddenSize + h] = d output_o / d (W1 x + b1)_h
+    std::vector<float> classFactors;
+    std::vector<float> relevance;
+    std::vector<float> heatMap;
+    int prediction = 0;
+};
@@ -0,0 +1,312 @@
+#include "NeuralNetwork.h"
+#include "Attribution.h"
+#include "LiveInference.h"
+#include "MNISTloader.h"
+#include "Preprocessing.h"
+#include "Brush.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Microbenchmarks for the network, the loaders and the drawn digit preprocessing.
+// Every benchmark is warmed up, then timed over several repetitions of a calibrated number of calls,
+// the median repetition is reported in ns/op together with GFLOP/s and GB/s from per-call estimates.
+class Benchmarks {
+public:
+    static int Run(int argc, char** argv);
+private:
+    struct Result {
+        std::string name;
+        long long callsPerRepetition = 0;
+        int repetitions = 0;
+        double medianNs = 0.0;
+        double minNs = 0.0;
+        double maxNs = 0.0;
+        double flopsPerOp = 0.0;
+        double bytesPerOp = 0.0;
+    };
+    struct Settings {
+        int repetitions = 10;
+        double minRepetitionSeconds = 0.05;
+        int cpu = 0;
+        std::string filter;
+    };
+
+    static Result Measure(const Settings& settings, const std::string& name, double flopsPerOp, double bytesPerOp, const std::function<void()>& op);
+    static bool PinThread(int cpu);
+    static std::string CpuName();
+    // Contents of a JSON string literal, escapes quotes, backslashes and control characters
+    static std::string JsonString(const std::string& text);
+    static std::string ToJson(const std::vector<Result>& results, const Settings& settings, bool pinned);
+};
+
+Benchmarks::Result Benchmarks::Measure(const Settings& settings, const std::string& name, const double flopsPerOp, const double bytesPerOp, const std::function<void()>& op) {
+    using Clock = std::chrono::steady_clock;
+
+    // Warmup and calibration: double the call count until one repetition takes long enough
+    long long calls = 1;
+    while (true) {
+        const auto start = Clock::now();
+        for (long long i = 0; i < calls; i++) op();
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= settings.minRepetitionSeconds || calls >= (1LL << 30)) break;
+        calls *= 2;
+    }
+
+    std::vector<double> samples;
+    samples.reserve(settings.repetitions);
+    for (int r = 0; r < settings.repetitions; r++) {
+        const auto start = Clock::now();
+        for (long long i = 0; i < calls; i++) op();
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        samples.push_back(ns / static_cast<double>(calls));
+    }
+    std::ranges::sort(samples);
+
+    Result result;
+    result.name = name;
+    result.callsPerRepetition = calls;
+    result.repetitions = settings.repetitions;
+    result.medianNs = samples[samples.size() / 2];
+    result.minNs = samples.front();
+    result.maxNs = samples.back();
+    result.flopsPerOp = flopsPerOp;
+    result.bytesPerOp = bytesPerOp;
+
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(14) << result.medianNs << " ns/op" << std::setprecision(2)
+              << std::setw(10) << flopsPerOp / result.medianNs << " GFLOP/s"
+              << std::setw(10) << bytesPerOp / result.medianNs << " GB/s" << std::defaultfloat << std::endl;
+    return result;
+}
+
+bool Benchmarks::PinThread(const int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+std::string Benchmarks::CpuName() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.starts_with("model name")) {
+            const auto colon = line.find(':');
+            if (colon != std::string::npos) return line.substr(colon + 2);
+        }
+    }
+    return "unknown";
+}
+
+std::string Benchmarks::JsonString(const std::string& text) {
+    std::ostringstream escaped;
+    for (const char c : text) {
+        if (c == '"' || c == '\\') escaped << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20) escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
+        else escaped << c;
+    }
+    return escaped.str();
+}
+
+std::string Benchmarks::ToJson(const std::vector<Result>& results, const Settings& settings, const bool pinned) {
+    std::ostringstream json;
+    json << "{\n";
+    json << "  \"cpu\": \"" << JsonString(CpuName()) << "\",\n";
+#ifdef __VERSION__
+    json << "  \"compiler\": \"" << JsonString(__VERSION__) << "\",\n";
+#endif
+    json << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    json << "  \"pinned_cpu\": " << (pinned ? settings.cpu : -1) << ",\n";
+    json << "  \"repetitions\": " << settings.repetitions << ",\n";
+    json << "  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        json << (i > 0 ? "," : "") << "\n    {\"name\": \"" << JsonString(r.name) << "\", \"calls_per_repetition\": " << r.callsPerRepetition
+             << ", \"ns_per_op\": " << r.medianNs << ", \"min_ns_per_op\": " << r.minNs << ", \"max_ns_per_op\": " << r.maxNs
+             << ", \"gflops\": " << r.flopsPerOp / r.medianNs << ", \"gbps\": " << r.bytesPerOp / r.medianNs << "}";
+    }
+    json << "\n  ]\n}\n";
+    return json.str();
+}
+
+int Benchmarks::Run(const int argc, char** argv) {
+    Settings settings;
+    std::string jsonPath;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--repetitions" && hasValue) settings.repetitions = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--min-time-ms" && hasValue) settings.minRepetitionSeconds = std::stod(argv[++i]) / 1000.0;
+        else if (arg == "--cpu" && hasValue) settings.cpu = std::stoi(argv[++i]);
+        else if (arg == "--filter" && hasValue) settings.filter = argv[++i];
+        else if (arg == "--json" && hasValue) jsonPath = argv[++i];
+        else {
+            std::cout << "Usage: bench [--repetitions N] [--min-time-ms N] [--cpu N] [--filter TEXT] [--json FILE]" << std::endl;
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    const bool pinned = PinThread(settings.cpu);
+    if (!pinned) std::cerr << "[BENCH] Could not pin the benchmark thread to cpu " << settings.cpu << std::endl;
+
+    constexpr int I = 784, H = 64, O = 10;
+    constexpr double f = sizeof(float);
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution dist(0.0f, 1.0f);
+    std::vector<float> input(I);
+    for (float& pixel : input) pixel = dist(gen);
+    std::vector target(O, 0.0f);
+    target[3] = 1.0f;
+
+    // A drawn digit: a ring in a corner of the full resolution 840x840 window canvas that Normalize has to move
+    std::vector processed(Preprocessing::pixelCount, 0.0f);
+    constexpr int canvasSize = 840;
+    std::vector<unsigned char> canvas(canvasSize * canvasSize, 0);
+    for (int y = 0; y < canvasSize; y++) {
+        for (int x = 0; x < canvasSize; x++) {
+            const float dx = static_cast<float>(x) - 240.0f, dy = static_cast<float>(y) - 270.0f;
+            const float r = std::sqrt(dx * dx + dy * dy);
+            if (r > 120.0f && r < 210.0f) canvas[y * canvasSize + x] = 255;
+        }
+    }
+    MnistNormalizer normalizer(canvasSize);
+    // The window brush moving 40 pixels per frame across the canvas
+    const Brush brush(30.0f);
+    std::vector<unsigned char> brushCanvas(canvasSize * canvasSize, 0);
+    int brushStep = 0;
+
+    // Synthetic MNIST image file so LoadImages does not depend on the dataset being present
+    constexpr int fileImages = 10000;
+    const auto idxPath = (std::filesystem::temp_directory_path() / "digitnet-bench-images.idx3-ubyte").string();
+    {
+        std::ofstream out(idxPath, std::ios::binary);
+        auto writeBigEndian = [&](const unsigned int v) {
+            const unsigned char bytes[4] = {static_cast<unsigned char>(v >> 24), static_cast<unsigned char>(v >> 16),
+                                            static_cast<unsigned char>(v >> 8), static_cast<unsigned char>(v)};
+            out.write(reinterpret_cast<const char*>(bytes), 4);
+        };
+        writeBigEndian(2051);
+        writeBigEndian(fileImages);
+        writeBigEndian(28);
+        writeBigEndian(28);
+        std::vector<unsigned char> pixels(static_cast<size_t>(fileImages) * I);
+        for (auto& p : pixels) p = static_cast<unsigned char>(gen() & 255);
+        out.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+    }
+    const double fileBytes = static_cast<double>(std::filesystem::file_size(idxPath));
+
+    NeuralNetwork network(I, H, O);
+    Attribution attribution(network);
+    LiveInference live(network);
+    std::vector<float> liveInput(input);
+    int liveStep = 0;
+    auto gradients = network.MakeGradients();
+    std::vector<float> batch(static_cast<size_t>(64) * I);
+    for (float& pixel : batch) pixel = dist(gen);
+    std::vector<float> batchOutputs(static_cast<size_t>(64) * O);
+
+    const double forwardFlops = 2.0 * (I * H + H * O);
+    const double weightBytes = f * (I * H + H * O + H + O);
+
+    struct Case {
+        std::string name;
+        double flops;
+        double bytes;
+        std::function<void()> op;
+    };
+    float sink = 0.0f;
+    const std::vector<Case> cases = {
+        {"FeedForward", forwardFlops, weightBytes + f * I, [&] {
+            sink += network.FeedForward(input)[0];
+        }},
+        {"FeedForwardBatch/64", 64.0 * forwardFlops, weightBytes + 64.0 * f * (I + O), [&] {
+            network.FeedForwardBatch(batch.data(), 64, batchOutputs.data());
+            sink += batchOutputs[0];
+        }},
+        // Forward, output and hidden deltas, then dW2 and dW1 read-modify-write
+        {"AccumulateGradient", 4.0 * I * H + 6.0 * H * O, weightBytes + f * (2 * I * H + 2 * H * O + I + O), [&] {
+            network.AccumulateGradient(input, target, gradients);
+        }},
+        {"ApplyGradient", 2.0 * (I * H + H * O + H + O), 3.0 * weightBytes, [&] {
+            network.ApplyGradient(gradients, 64, 0.0f);
+        }},
+        {"RelevanceMap", 4.0 * I * H + 4.0 * H * O, 2.0 * f * I * H + f * (2 * H * O + 2 * I), [&] {
+            sink += network.RelevanceMap(input, 3)[0];
+        }},
+        // Forward pass, then all classes and the heat map from one more pass over W1
+        {"Attribution::Compute", 2.0 * I * H + 2.0 * O * I * H + 3.0 * I * H + 2.0 * H * O, 2.0 * f * I * H + f * (2 * H * O + O * I + I), [&] {
+            attribution.Compute(input.data());
+            sink += attribution.Relevances()[0];
+        }},
+        {"MNISTloader::LoadImages", 0.0, fileBytes, [&] {
+            sink += MNISTloader::LoadImages(idxPath)[0][0];
+        }},
+        {"MNISTloader::LoadImageBytes", 0.0, fileBytes, [&] {
+            sink += MNISTloader::LoadImageBytes(idxPath)[0];
+        }},
+        // A brush step: 4 changed pixels, hiddenSize multiply-adds each, then the output layer
+        {"LiveInference::Update/4px", 4.0 * 2.0 * H + forwardFlops - 2.0 * I * H, f * (4.0 * H + H * O), [&] {
+            for (int p = 0; p < 4; p++) liveInput[(liveStep * 4 + p) % I] += 0.5f;
+            liveStep++;
+            live.Update(liveInput.data());
+            sink += live.Outputs()[0];
+        }},
+        // Byte ORs over the canvas, then the summed area table of the bounding box
+        {"MnistNormalizer::Normalize", 0.0, canvasSize * canvasSize + 420.0 * 420.0 * 5.0, [&] {
+            normalizer.Normalize(canvas.data(), processed.data());
+            sink += processed[9 * 28 + 14];
+        }},
+        // 6 stamps of the 61x61 bounding box, one byte read and written per cell
+        {"Brush::Stroke/40px", 0.0, 2.0 * 6.0 * 61.0 * 61.0, [&] {
+            const float x = 60.0f + static_cast<float>(brushStep % 18) * 40.0f;
+            brushStep++;
+            brush.Stroke(brushCanvas.data(), canvasSize, canvasSize, x, 420.0f, x + 40.0f, 420.0f);
+            sink += brushCanvas[420 * canvasSize + 100];
+        }},
+    };
+
+    std::vector<Result> results;
+    for (const auto& c : cases) {
+        if (!settings.filter.empty() && c.name.find(settings.filter) == std::string::npos) continue;
+        results.push_back(Measure(settings, c.name, c.flops, c.bytes, c.op));
+    }
+    std::filesystem::remove(idxPath);
+    std::cout << "[BENCH] Checksum: " << sink << std::endl;
+
+    if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        if (!out.is_open()) {
+            std::cerr << "[BENCH] Cannot open path: " << jsonPath << std::endl;
+            return 1;
+        }
+        out << ToJson(results, settings, pinned);
+        std::cout << "[BENCH] Results written to: " << jsonPath << std::endl;
+    }
+    return 0;
+}
+
+int main(const int argc, char** argv) {
+    return Benchmarks::Run(argc, argv);
+}
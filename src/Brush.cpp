@@ -0,0 +1,89 @@
+#include "Brush.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+Brush::Brush(const float radius, const float softness)
+    : radius(std::max(radius, 0.0f)),
+      falloff(std::max(1.0f, std::clamp(softness, 0.0f, 1.0f) * this->radius)),
+      inner(std::max(0.0f, this->radius - falloff * 0.5f)),
+      outer(this->radius + falloff * 0.5f),
+      // A quarter radius keeps the edge of a stroke smooth, the scallops between stamps are below a cell
+      spacing(std::max(0.25f, this->radius * 0.25f)) {}
+
+float Brush::Coverage(const float distance) const {
+    return std::clamp((outer - distance) / falloff, 0.0f, 1.0f);
+}
+
+template<typename Cell>
+void Brush::StampCells(Cell* grid, const int width, const int height, const float x, const float y, const float value) const {
+    auto paint = [value](Cell& cell, const float coverage) {
+        if constexpr (std::is_same_v<Cell, unsigned char>) {
+            cell = std::max(cell, static_cast<unsigned char>(coverage * value + 0.5f));
+        }
+        else {
+            cell = std::max(cell, coverage * value);
+        }
+    };
+    // First and last cell whose center is less than half away from x, clamped to the grid
+    auto span = [&](const float half, int& first, int& last) {
+        first = std::max(0, static_cast<int>(std::ceil(x - half - 0.5f)));
+        last = std::min(width - 1, static_cast<int>(std::floor(x + half - 0.5f)));
+    };
+
+    const int firstY = std::max(0, static_cast<int>(std::ceil(y - outer - 0.5f)));
+    const int lastY = std::min(height - 1, static_cast<int>(std::floor(y + outer - 0.5f)));
+    for (int cy = firstY; cy <= lastY; cy++) {
+        const float dy = static_cast<float>(cy) + 0.5f - y;
+        const float dySquared = dy * dy;
+        if (dySquared >= outer * outer) continue;
+        Cell* row = grid + static_cast<std::size_t>(cy) * width;
+
+        // Per row the brush is the span within outer, its middle within inner is fully covered and needs no sqrt
+        int first, last, innerFirst = 0, innerLast = -1;
+        span(std::sqrt(outer * outer - dySquared), first, last);
+        if (dySquared < inner * inner) span(std::sqrt(inner * inner - dySquared), innerFirst, innerLast);
+        if (innerFirst > innerLast) innerFirst = innerLast = last + 1;
+
+        for (int cx = first; cx < innerFirst; cx++) {
+            const float dx = static_cast<float>(cx) + 0.5f - x;
+            paint(row[cx], Coverage(std::sqrt(dx * dx + dySquared)));
+        }
+        for (int cx = innerFirst; cx <= innerLast && cx <= last; cx++) paint(row[cx], 1.0f);
+        for (int cx = std::max(first, innerLast + 1); cx <= last; cx++) {
+            const float dx = static_cast<float>(cx) + 0.5f - x;
+            paint(row[cx], Coverage(std::sqrt(dx * dx + dySquared)));
+        }
+    }
+}
+
+template<typename Cell>
+void Brush::StrokeCells(Cell* grid, const int width, const int height, const float fromX, const float fromY,
+                        const float toX, const float toY, const float value) const {
+    const float dx = toX - fromX, dy = toY - fromY;
+    const int steps = std::max(1, static_cast<int>(std::ceil(std::sqrt(dx * dx + dy * dy) / spacing)));
+    for (int s = 1; s <= steps; s++) {
+        const float t = static_cast<float>(s) / static_cast<float>(steps);
+        StampCells(grid, width, height, fromX + dx * t, fromY + dy * t, value);
+    }
+}
+
+void Brush::Stamp(float* grid, const int width, const int height, const float x, const float y, const float pressure) const {
+    StampCells(grid, width, height, x, y, std::clamp(pressure, 0.0f, 1.0f));
+}
+
+void Brush::Stamp(unsigned char* grid, const int width, const int height, const float x, const float y, const float pressure) const {
+    StampCells(grid, width, height, x, y, 255.0f * std::clamp(pressure, 0.0f, 1.0f));
+}
+
+void Brush::Stroke(float* grid, const int width, const int height, const float fromX, const float fromY,
+                   const float toX, const float toY, const float pressure) const {
+    StrokeCells(grid, width, height, fromX, fromY, toX, toY, std::clamp(pressure, 0.0f, 1.0f));
+}
+
+void Brush::Stroke(unsigned char* grid, const int width, const int height, const float fromX, const float fromY,
+                   const float toX, const float toY, const float pressure) const {
+    StrokeCells(grid, width, height, fromX, fromY, toX, toY, 255.0f * std::clamp(pressure, 0.0f, 1.0f));
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// Round brush that paints into flat row-major grids (the 0-1 float display grid or a 0-255 byte canvas) without any
+// graphics dependency. Positions and the radius are in cells of the grid painted into, cell (x, y) covers
+// [x, x + 1) x [y, y + 1). A stamp only visits the cells of its bounding box, so its cost depends on the radius and
+// not on the grid size. Cells keep the maximum of their value and the brush, painting over a stroke never darkens it.
+class Brush {
+public:
+    // softness 0 gives a hard edge anti-aliased over one cell, 1 fades out over the whole radius
+    explicit Brush(float radius, float softness = 0.0f);
+
+    // 0-1 at a cell center this far from the brush center, before pressure
+    [[nodiscard]] float Coverage(float distance) const;
+
+    // pressure scales the coverage (1 for a mouse)
+    void Stamp(float* grid, int width, int height, float x, float y, float pressure = 1.0f) const;
+    void Stamp(unsigned char* grid, int width, int height, float x, float y, float pressure = 1.0f) const;
+    // Stamps from (fromX, fromY), excluded since the previous call painted it, to (toX, toY) at most spacing apart,
+    // so fast strokes leave no gaps. A zero length stroke is one stamp.
+    void Stroke(float* grid, int width, int height, float fromX, float fromY, float toX, float toY, float pressure = 1.0f) const;
+    void Stroke(unsigned char* grid, int width, int height, float fromX, float fromY, float toX, float toY, float pressure = 1.0f) const;
+
+    [[nodiscard]] float Radius() const { return radius; }
+private:
+    template<typename Cell>
+    void StampCells(Cell* grid, int width, int height, float x, float y, float value) const;
+    template<typename Cell>
+    void StrokeCells(Cell* grid, int width, int height, float fromX, float fromY, float toX, float toY, float value) const;
+
+    float radius;
+    // Width of the edge band centered on the radius, coverage goes from 1 to 0 across it
+    float falloff;
+    // Cells closer than inner are fully covered, cells farther than outer not at all, only the band needs a sqrt
+    float inner;
+    float outer;
+    float spacing;
+};
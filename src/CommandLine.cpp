@@ -0,0 +1,452 @@
+#include "CommandLine.h"
+#include "AllocationTracker.h"
+#include "NeuralNetwork.h"
+#include "MNISTloader.h"
+#include "CustomLoader.h"
+#include "Evaluator.h"
+#include "InferenceServer.h"
+#include "PerfCounters.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include "TrainingBenchmark.h"
+#include "TimerChrono.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+int CommandLine::Run(const int argc, char** argv) {
+    if (argc < 2) {
+        PrintUsage();
+        return 1;
+    }
+
+    const std::string command = argv[1];
+    try {
+        const Options options = ParseOptions(argc, argv, 2);
+        PerfCounters::SetEnabled(options.contains("counters"));
+        if (command == "train") return Train(options);
+        if (command == "eval") return Eval(options);
+        if (command == "predict") return Predict(options);
+        if (command == "bench") return Bench(options);
+        if (command == "bench-train") return BenchTrain(options);
+        if (command == "serve") return Serve(options);
+        if (command == "loadgen") return LoadGen(options);
+        if (command == "alloccheck") return AllocCheck(options);
+        if (command == "help" || command == "--help") {
+            PrintUsage();
+            return 0;
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[CLI] " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cerr << "[CLI] Unknown command: " << command << std::endl;
+    PrintUsage();
+    return 1;
+}
+
+CommandLine::Options CommandLine::ParseOptions(const int argc, char** argv, const int first) {
+    Options options;
+    for (int i = first; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (!arg.starts_with("--")) throw std::invalid_argument("Unexpected argument: " + arg);
+
+        const std::string name = arg.substr(2);
+        if (i + 1 < argc && !std::string(argv[i + 1]).starts_with("--")) {
+            options[name] = argv[++i];
+        }
+        else {
+            options[name] = "";
+        }
+    }
+    return options;
+}
+
+std::string CommandLine::GetString(const Options& options, const std::string& name, const std::string& fallback) {
+    const auto it = options.find(name);
+    return it != options.end() && !it->second.empty() ? it->second : fallback;
+}
+
+int CommandLine::GetInt(const Options& options, const std::string& name, const int fallback) {
+    const auto it = options.find(name);
+    return it != options.end() && !it->second.empty() ? std::stoi(it->second) : fallback;
+}
+
+float CommandLine::GetFloat(const Options& options, const std::string& name, const float fallback) {
+    const auto it = options.find(name);
+    return it != options.end() && !it->second.empty() ? std::stof(it->second) : fallback;
+}
+
+bool CommandLine::ReadImage(const std::string& filePath, const int index, std::vector<float>& image) {
+    if (!std::filesystem::exists(filePath)) {
+        std::cerr << "[CLI] Could not find file: " << filePath << std::endl;
+        return false;
+    }
+
+    if (filePath.ends_with("idx3-ubyte")) {
+        const auto images = MNISTloader::LoadImages(filePath);
+        if (index < 0 || index >= static_cast<int>(images.size())) {
+            std::cerr << "[CLI] Image index out of range: " << index << " (" << images.size() << " images)" << std::endl;
+            return false;
+        }
+        image = images[index];
+        return true;
+    }
+
+    // Raw 28x28 image either as grayscale bytes or as floats between 0 and 1
+    const auto fileSize = std::filesystem::file_size(filePath);
+    std::ifstream in(filePath, std::ios::binary);
+    image.assign(784, 0.0f);
+    if (fileSize == 784) {
+        for (float& pixel : image) {
+            unsigned char value = 0;
+            in.read(reinterpret_cast<char*>(&value), sizeof(value));
+            pixel = static_cast<float>(value) / 255.0f;
+        }
+        return true;
+    }
+    if (fileSize == 784 * sizeof(float)) {
+        in.read(reinterpret_cast<char*>(image.data()), static_cast<std::streamsize>(784 * sizeof(float)));
+        return true;
+    }
+
+    std::cerr << "[CLI] Expected an idx3-ubyte file, 784 bytes or 784 floats: " << filePath << std::endl;
+    return false;
+}
+
+int CommandLine::Train(const Options& options) {
+    const int epochs = GetInt(options, "epochs", 1);
+    const float learningRate = GetFloat(options, "lr", 0.1f);
+    const int threads = GetInt(options, "threads", static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+    const std::string model = GetString(options, "model", "neural_network_save");
+    if (epochs <= 0 || learningRate <= 0.0f) {
+        std::cerr << "[N.N. TRAINER] Only positive values are allowed!" << std::endl;
+        return 1;
+    }
+
+    NeuralNetwork network(784, 64, 10);
+    if (!options.contains("fresh")) network.LoadNetwork(model);
+
+    auto X = MNISTloader::LoadImages(GetString(options, "images", "data/train-images.idx3-ubyte"));
+    const auto labels = MNISTloader::LoadLabels(GetString(options, "labels", "data/train-labels.idx1-ubyte"));
+    if (X.size() != labels.size()) {
+        std::cerr << "[CLI] Image and label count differ: " << X.size() << " / " << labels.size() << std::endl;
+        return 1;
+    }
+
+    std::vector<std::vector<float>> Y;
+    Y.reserve(labels.size());
+    for (const int label : labels) {
+        std::vector oneHot(10, 0.0f);
+        oneHot[label] = 1.0f;
+        Y.push_back(oneHot);
+    }
+    if (options.contains("custom")) {
+        const std::string customPath = GetString(options, "custom", "custom-train-images-and-labels");
+        if (!std::filesystem::exists(customPath)) {
+            std::cerr << "[CLI] Could not find file: " << customPath << std::endl;
+            return 1;
+        }
+        for (auto& [image, label] : CustomLoader::LoadImages(customPath)) {
+            if (label < 0 || label > 9 || static_cast<int>(image.size()) != CustomLoader::pixelCount) {
+                std::cerr << "[CLI] Invalid custom image: label " << label << ", " << image.size() << " pixels" << std::endl;
+                return 1;
+            }
+            X.push_back(image);
+            std::vector oneHot(10, 0.0f);
+            oneHot[label] = 1.0f;
+            Y.push_back(oneHot);
+        }
+    }
+
+    // Progress goes to the console between the per-epoch lines and, with --metrics, every report to a key=value file
+    std::ofstream metrics;
+    if (options.contains("metrics")) {
+        metrics.open(options.at("metrics"), std::ios::app);
+        if (!metrics.is_open()) {
+            std::cerr << "[CLI] Cannot open path: " << options.at("metrics") << std::endl;
+            return 1;
+        }
+    }
+    network.SetProgressCallback([&metrics](const TrainingProgress& progress) {
+        if (metrics.is_open()) metrics << progress.ToLine() << std::endl;
+        if (progress.epochDone) return;
+        std::cout << "[CLI] Epoch " << progress.epoch << ": " << progress.samples << " / " << progress.samplesPerEpoch << " | Loss: " << progress.loss
+                  << " | Accuracy: " << progress.accuracy * 100.0 << "% | " << static_cast<long long>(progress.samplesPerSecond)
+                  << " samples/s | ETA " << static_cast<long long>(progress.etaSeconds) << " s" << std::endl;
+    }, GetInt(options, "report-batches", 200));
+
+    std::cout << "[CLI] Training " << epochs << " epoch(s) on " << X.size() << " images with " << threads << " thread(s)" << std::endl;
+    {
+        auto timer = TimerChrono("Training network took");
+        network.TrainNetwork(X, Y, learningRate, epochs, threads, model);
+    }
+    return WriteProfile(options);
+}
+
+int CommandLine::Eval(const Options& options) {
+    NeuralNetwork network(784, 64, 10);
+    if (!network.LoadNetwork(GetString(options, "model", "neural_network_save"))) return 1;
+
+    const auto images = MNISTloader::LoadImageBytes(GetString(options, "images", "data/t10k-images.idx3-ubyte"));
+    const auto labels = MNISTloader::LoadLabels(GetString(options, "labels", "data/t10k-labels.idx1-ubyte"));
+    ThreadPool pool(GetInt(options, "threads", static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))));
+
+    const EvaluationReport report = Evaluator::Evaluate(network, images, labels, pool);
+    report.Print();
+    if (WriteProfile(options) != 0) return 1;
+
+    if (options.contains("json")) {
+        const std::string jsonPath = options.at("json");
+        std::ofstream out(jsonPath);
+        if (!out.is_open()) {
+            std::cerr << "[CLI] Cannot open path: " << jsonPath << std::endl;
+            return 1;
+        }
+        out << report.ToJson();
+        std::cout << "[N.N. TEST] Report written to: " << jsonPath << std::endl;
+    }
+    return 0;
+}
+
+int CommandLine::Predict(const Options& options) {
+    if (!options.contains("input")) {
+        std::cerr << "[CLI] predict needs --input <file>" << std::endl;
+        return 1;
+    }
+
+    NeuralNetwork network(784, 64, 10);
+    if (!network.LoadNetwork(GetString(options, "model", "neural_network_save"))) return 1;
+
+    std::vector<float> image;
+    if (!ReadImage(options.at("input"), GetInt(options, "index", 0), image)) return 1;
+
+    const auto outputs = network.FeedForward(image);
+    for (int number = 0; number < 10; number++) {
+        std::cout << number << ": " << outputs[number] * 100 << "%" << std::endl;
+    }
+    const int index = static_cast<int>(std::distance(outputs.begin(), std::ranges::max_element(outputs)));
+    std::cout << "The number shown is: " << index << " | Probability: " << outputs[index] * 100 << "%" << std::endl;
+    return 0;
+}
+
+int CommandLine::Bench(const Options& options) {
+    const int iterations = GetInt(options, "iterations", 10000);
+    const int samples = GetInt(options, "samples", 6000);
+    const int threads = GetInt(options, "threads", static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+    if (iterations < 1 || samples < 1) {
+        std::cerr << "[CLI] bench needs --iterations and --samples of at least 1" << std::endl;
+        return 1;
+    }
+
+    // Synthetic inputs from a fixed seed so the numbers do not depend on the dataset being present
+    std::mt19937 gen(42);
+    std::uniform_real_distribution dist(0.0f, 1.0f);
+    std::uniform_int_distribution digit(0, 9);
+    std::vector X(samples, std::vector<float>(784));
+    std::vector Y(samples, std::vector(10, 0.0f));
+    for (int n = 0; n < samples; n++) {
+        for (float& pixel : X[n]) pixel = dist(gen);
+        Y[n][digit(gen)] = 1.0f;
+    }
+
+    NeuralNetwork network(784, 64, 10);
+    float sink = 0.0f;
+    for (int i = 0; i < std::min(iterations, 100); i++) {
+        sink += network.FeedForward(X[i % samples])[0];
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        sink += network.FeedForward(X[i % samples])[0];
+    }
+    const std::chrono::duration<double> inference = std::chrono::steady_clock::now() - start;
+
+    std::vector<float> flat;
+    flat.reserve(static_cast<size_t>(samples) * 784);
+    for (const auto& image : X) flat.insert(flat.end(), image.begin(), image.end());
+    std::vector<float> outputs(static_cast<size_t>(samples) * 10);
+    network.FeedForwardBatch(flat.data(), samples, outputs.data(), threads);
+
+    const int batchRounds = std::max(1, iterations / std::max(1, samples));
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < batchRounds; r++) {
+        network.FeedForwardBatch(flat.data(), samples, outputs.data(), threads);
+        sink += outputs[r % outputs.size()];
+    }
+    const std::chrono::duration<double> batched = std::chrono::steady_clock::now() - start;
+    const double batchedImages = static_cast<double>(batchRounds) * samples;
+
+    start = std::chrono::steady_clock::now();
+    network.TrainNetwork(X, Y, 0.1f, 1, threads, "");
+    const std::chrono::duration<double> training = std::chrono::steady_clock::now() - start;
+
+    std::cout << "[BENCH] FeedForward: " << inference.count() * 1e6 / iterations << " us/image, "
+              << iterations / inference.count() << " images/s" << std::endl;
+    std::cout << "[BENCH] FeedForwardBatch (" << threads << " thread(s)): " << batched.count() * 1e6 / batchedImages << " us/image, "
+              << batchedImages / batched.count() << " images/s" << std::endl;
+    std::cout << "[BENCH] TrainNetwork (" << threads << " thread(s)): " << training.count() * 1e3 << " ms/epoch, "
+              << samples / training.count() << " samples/s" << std::endl;
+    std::cout << "[BENCH] Checksum: " << sink << std::endl;
+    return 0;
+}
+
+int CommandLine::BenchTrain(const Options& options) {
+    TrainingBenchmark::Settings settings;
+    settings.seed = static_cast<unsigned int>(GetInt(options, "seed", static_cast<int>(settings.seed)));
+    settings.threads = GetInt(options, "threads", static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+    settings.learningRate = GetFloat(options, "lr", settings.learningRate);
+    settings.targetAccuracy = GetFloat(options, "target", static_cast<float>(settings.targetAccuracy));
+    settings.maxEpochs = GetInt(options, "max-epochs", settings.maxEpochs);
+    settings.trainImages = GetString(options, "images", settings.trainImages);
+    settings.trainLabels = GetString(options, "labels", settings.trainLabels);
+    settings.testImages = GetString(options, "test-images", settings.testImages);
+    settings.testLabels = GetString(options, "test-labels", settings.testLabels);
+
+    const auto result = TrainingBenchmark::Run(settings);
+    if (WriteProfile(options) != 0) return 1;
+    std::cout << "[E2E BENCH] " << result.samplesPerSecond << " samples/s, " << result.epochSeconds << " s/epoch, peak RSS "
+              << result.peakRssKb << " KB, final accuracy " << result.finalAccuracy * 100.0 << "%" << std::endl;
+    if (result.timeToTargetSeconds >= 0.0) {
+        std::cout << "[E2E BENCH] Reached " << settings.targetAccuracy * 100.0 << "% after " << result.timeToTargetSeconds << " s of training" << std::endl;
+    }
+    else {
+        std::cout << "[E2E BENCH] Target " << settings.targetAccuracy * 100.0 << "% not reached in " << settings.maxEpochs << " epoch(s)" << std::endl;
+    }
+
+    if (options.contains("json")) {
+        std::ofstream out(options.at("json"));
+        if (!out.is_open()) {
+            std::cerr << "[CLI] Cannot open path: " << options.at("json") << std::endl;
+            return 1;
+        }
+        out << result.ToJson();
+    }
+
+    if (options.contains("baseline")) {
+        std::ifstream in(options.at("baseline"));
+        if (!in.is_open()) {
+            std::cerr << "[CLI] Cannot open baseline: " << options.at("baseline") << std::endl;
+            return 1;
+        }
+        const std::string baseline((std::istreambuf_iterator(in)), std::istreambuf_iterator<char>());
+        if (TrainingBenchmark::CompareToBaseline(result, baseline, GetFloat(options, "threshold", 0.1f))) return 2;
+    }
+    return 0;
+}
+
+int CommandLine::Serve(const Options& options) {
+    NeuralNetwork network(784, 64, 10);
+    if (!network.LoadNetwork(GetString(options, "model", "neural_network_save"))) return 1;
+
+    InferenceServer server(network, GetInt(options, "max-batch", 32), GetInt(options, "max-delay-us", 500));
+    return server.Serve(GetString(options, "socket", "/tmp/digitnet.sock"), GetInt(options, "report-seconds", 5), GetInt(options, "duration", 0));
+}
+
+int CommandLine::LoadGen(const Options& options) {
+    const int clients = GetInt(options, "clients", 8);
+    const int requests = GetInt(options, "requests", 1000);
+    if (clients < 1 || requests < 1) {
+        std::cerr << "[CLI] loadgen needs --clients and --requests of at least 1" << std::endl;
+        return 1;
+    }
+    std::vector<std::vector<float>> images;
+    if (options.contains("images")) images = MNISTloader::LoadImages(options.at("images"));
+
+    return InferenceServer::RunLoadGenerator(GetString(options, "socket", "/tmp/digitnet.sock"), clients, requests, images);
+}
+
+int CommandLine::AllocCheck(const Options& options) {
+    if (!AllocationTracker::enabled) {
+        std::cerr << "[ALLOC CHECK] Built without allocation tracking, configure with -DDIGITNET_TRACK_ALLOCATIONS=ON" << std::endl;
+        return 1;
+    }
+    const int iterations = std::max(1, GetInt(options, "iterations", 100));
+
+    constexpr int batch = 64;
+    std::mt19937 gen(42);
+    std::uniform_real_distribution dist(0.0f, 1.0f);
+    std::vector<float> floats(static_cast<size_t>(batch) * 784);
+    for (float& pixel : floats) pixel = dist(gen);
+    std::vector<unsigned char> bytes(floats.size());
+    for (size_t i = 0; i < bytes.size(); i++) bytes[i] = static_cast<unsigned char>(floats[i] * 255.0f);
+    std::vector<float> outputs(static_cast<size_t>(batch) * 10);
+
+    NeuralNetwork network(784, 64, 10, 42);
+    bool failed = false;
+    auto report = [&](const std::string& name, const AllocationTracker::Counts& used, const int calls) {
+        const bool ok = used.allocations == 0;
+        failed |= !ok;
+        std::cout << "[ALLOC CHECK] " << (ok ? "OK   " : "FAIL ") << name << ": " << static_cast<double>(used.allocations) / calls
+                  << " allocation(s), " << static_cast<double>(used.bytes) / calls << " bytes per call" << std::endl;
+    };
+
+    // Inference: one warmup call grows the per thread scratch, every following call must not allocate
+    auto inference = [&](const std::string& name, const std::function<void()>& step) {
+        step();
+        const auto before = AllocationTracker::Process();
+        for (int i = 0; i < iterations; i++) step();
+        report(name, AllocationTracker::Process() - before, iterations);
+    };
+    inference("FeedForwardBatch float x1", [&] { network.FeedForwardBatch(floats.data(), 1, outputs.data()); });
+    inference("FeedForwardBatch byte x1", [&] { network.FeedForwardBatch(bytes.data(), 1, outputs.data()); });
+    inference("FeedForwardBatch float x64", [&] { network.FeedForwardBatch(floats.data(), batch, outputs.data()); });
+
+    // Training: TrainNetwork allocates its gradient buffers and workers once per call, so a run over
+    // iterations + 1 batches may only allocate as much as a run over a single batch
+    std::vector X(static_cast<size_t>(batch) * (iterations + 1), std::vector<float>(784));
+    std::vector Y(X.size(), std::vector(10, 0.0f));
+    for (size_t n = 0; n < X.size(); n++) {
+        std::copy_n(floats.begin() + static_cast<std::ptrdiff_t>(n % batch) * 784, 784, X[n].begin());
+        Y[n][n % 10] = 1.0f;
+    }
+    const std::vector oneX(X.begin(), X.begin() + batch);
+    const std::vector oneY(Y.begin(), Y.begin() + batch);
+    for (const int threads : {1, 2}) {
+        auto train = [&](const std::vector<std::vector<float>>& images, const std::vector<std::vector<float>>& labels) {
+            const auto before = AllocationTracker::Process();
+            network.TrainNetwork(images, labels, 0.1f, 1, threads, "");
+            return AllocationTracker::Process() - before;
+        };
+        train(oneX, oneY);
+        const auto single = train(oneX, oneY);
+        const auto many = train(X, Y);
+        report("Training step, " + std::to_string(threads) + " thread(s)", many - single, iterations);
+    }
+
+    return failed ? 1 : 0;
+}
+
+int CommandLine::WriteProfile(const Options& options) {
+    if (!options.contains("profile")) return 0;
+    Profiler::PrintSummary();
+    if (!Profiler::enabled) return 0;
+    return Profiler::WriteChromeTrace(options.at("profile")) ? 0 : 1;
+}
+
+void CommandLine::PrintUsage() {
+    std::cout << "Usage: AI [command] [options]\n"
+              << "  (no command)                       open the drawing window\n"
+              << "  train   --epochs N --lr F --threads N --model FILE [--fresh] [--custom [FILE]]\n"
+              << "          [--images FILE --labels FILE] [--profile FILE] [--metrics FILE --report-batches N]\n"
+              << "  eval    --model FILE --threads N [--json FILE] [--images FILE --labels FILE] [--profile FILE]\n"
+              << "  predict --model FILE --input FILE [--index N]\n"
+              << "          input is an idx3-ubyte file, 784 grayscale bytes or 784 floats\n"
+              << "  bench   --iterations N --samples N --threads N\n"
+              << "  bench-train --seed N --threads N --lr F --target F --max-epochs N [--json FILE]\n"
+              << "          [--baseline FILE --threshold F] [--profile FILE]   exits with 2 on a regression against the baseline\n"
+              << "  serve   --model FILE --socket PATH --max-batch N --max-delay-us N [--report-seconds N --duration N]\n"
+              << "  loadgen --socket PATH --clients N --requests N [--images FILE]\n"
+              << "  alloccheck --iterations N   exits with 1 when inference or a training step allocates after warmup\n"
+              << "              (needs a build with -DDIGITNET_TRACK_ALLOCATIONS=ON)\n"
+              << "  --counters  (train, eval, bench-train) read cycles, instructions, LLC and branch misses per epoch\n"
+              << "              and per profiling zone through perf_event_open (Linux only)\n";
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Headless entry point: none of these subcommands touch GLFW, OpenGL, FreeType or miniaudio
+class CommandLine {
+public:
+    static int Run(int argc, char** argv);
+private:
+    // A flag given without a value maps to an empty string, the getters return their fallback for it
+    using Options = std::unordered_map<std::string, std::string>;
+
+    static Options ParseOptions(int argc, char** argv, int first);
+    static std::string GetString(const Options& options, const std::string& name, const std::string& fallback);
+    static int GetInt(const Options& options, const std::string& name, int fallback);
+    static float GetFloat(const Options& options, const std::string& name, float fallback);
+    static bool ReadImage(const std::string& filePath, int index, std::vector<float>& image);
+
+    static int Train(const Options& options);
+    static int Eval(const Options& options);
+    static int Predict(const Options& options);
+    static int Bench(const Options& options);
+    static int BenchTrain(const Options& options);
+    static int Serve(const Options& options);
+    static int LoadGen(const Options& options);
+    static int AllocCheck(const Options& options);
+    // Prints the profiling zone summary and writes the Chrome trace when --profile FILE is given
+    static int WriteProfile(const Options& options);
+    static void PrintUsage();
+};
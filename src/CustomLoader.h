@@ -4,10 +4,11 @@
 
 class CustomLoader {
 public:
+    static constexpr int pixelCount = 784;
+
+    // Records with another pixel count end the file, records with a label outside 0-9 are skipped
     static std::vector<std::pair<std::vector<float>, int>> LoadImages(const std::string &filePath);
-    static void SaveImage(const std::vector<std::vector<float>> &imageDrawn, int label, const std::string &filePath, int imageSize);
+    // image is the preprocessed 28x28 network input, saved as it is
+    static void SaveImage(const std::vector<float> &image, int label, const std::string &filePath);
     static std::vector<int> LoadLabels(const std::string &filePath);
-private:
-    static std::vector<std::vector<float>> CenterImage(std::vector<std::vector<float>> image, int imageSize);
-    static std::vector<std::vector<float>> GaussianBlur(const std::vector<std::vector<float>>& image);
 };
\ No newline at end of file
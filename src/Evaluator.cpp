@@ -0,0 +1,139 @@
+#include "Evaluator.h"
+#include "NeuralNetwork.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+void EvaluationReport::Print() const {
+    std::cout << "[N.N. TEST] Test accuracy: " << accuracy * 100.0 << "% (" << correct << "/" << total << ")" << std::endl;
+    std::cout << "[N.N. TEST] Mean confidence: " << meanConfidence * 100.0 << "%" << std::endl;
+    std::cout << "[N.N. TEST] " << imagesPerSecond << " images/s with " << threads << " thread(s), "
+              << latencyPerImageUs << " us per image" << std::endl;
+
+    std::cout << "[N.N. TEST] Digit | Precision | Recall | Predicted as 0..9" << std::endl;
+    for (int d = 0; d < 10; d++) {
+        std::cout << "[N.N. TEST] " << std::setw(5) << d << " | " << std::setw(8) << std::fixed << std::setprecision(2) << precision[d] * 100.0
+                  << "% | " << std::setw(5) << recall[d] * 100.0 << "% |" << std::defaultfloat << std::setprecision(6);
+        for (int p = 0; p < 10; p++) {
+            std::cout << " " << std::setw(5) << confusion[d][p];
+        }
+        std::cout << std::endl;
+    }
+}
+
+std::string EvaluationReport::ToJson() const {
+    std::ostringstream json;
+    auto writeArray = [&](const auto& values) {
+        json << "[";
+        for (size_t i = 0; i < values.size(); i++) {
+            json << (i > 0 ? ", " : "") << values[i];
+        }
+        json << "]";
+    };
+
+    json << "{\n";
+    json << "  \"total\": " << total << ",\n";
+    json << "  \"correct\": " << correct << ",\n";
+    json << "  \"accuracy\": " << accuracy << ",\n";
+    json << "  \"mean_confidence\": " << meanConfidence << ",\n";
+    json << "  \"threads\": " << threads << ",\n";
+    json << "  \"seconds\": " << seconds << ",\n";
+    json << "  \"images_per_second\": " << imagesPerSecond << ",\n";
+    json << "  \"latency_per_image_us\": " << latencyPerImageUs << ",\n";
+    json << "  \"precision\": ";
+    writeArray(precision);
+    json << ",\n  \"recall\": ";
+    writeArray(recall);
+    json << ",\n  \"confusion\": [";
+    for (int d = 0; d < 10; d++) {
+        json << (d > 0 ? ",\n    " : "\n    ");
+        writeArray(confusion[d]);
+    }
+    json << "\n  ]\n}\n";
+    return json.str();
+}
+
+EvaluationReport Evaluator::Evaluate(const NeuralNetwork& network, const std::vector<unsigned char>& images, const std::vector<int>& labels, ThreadPool& pool) {
+    struct ChunkResult {
+        std::array<std::array<int, 10>, 10> confusion{};
+        double confidence = 0.0;
+        double seconds = 0.0;
+    };
+
+    const int total = static_cast<int>(std::min(images.size() / 784, labels.size()));
+    const int chunks = (total + chunkSize - 1) / chunkSize;
+    std::vector<ChunkResult> results(chunks);
+    std::vector<std::future<void>> pending;
+    pending.reserve(chunks);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < chunks; c++) {
+        pending.push_back(pool.Submit([&, c] {
+            const auto chunkStart = std::chrono::steady_clock::now();
+            const int begin = c * chunkSize;
+            const int count = std::min(chunkSize, total - begin);
+
+            std::vector<float> outputs(static_cast<size_t>(count) * 10);
+            network.FeedForwardBatch(images.data() + static_cast<size_t>(begin) * 784, count, outputs.data());
+
+            ChunkResult& result = results[c];
+            for (int i = 0; i < count; i++) {
+                const float* output = outputs.data() + static_cast<size_t>(i) * 10;
+                const auto best = std::max_element(output, output + 10);
+                const int label = labels[begin + i];
+                if (label < 0 || label > 9) continue;
+                result.confusion[label][best - output]++;
+                result.confidence += *best;
+            }
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - chunkStart).count();
+        }));
+    }
+    for (auto& future : pending) future.get();
+
+    EvaluationReport report;
+    report.total = total;
+    report.threads = pool.Size();
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double confidence = 0.0;
+    double computeSeconds = 0.0;
+    for (const auto& result : results) {
+        for (int a = 0; a < 10; a++) {
+            for (int p = 0; p < 10; p++) {
+                report.confusion[a][p] += result.confusion[a][p];
+            }
+        }
+        confidence += result.confidence;
+        computeSeconds += result.seconds;
+    }
+
+    for (int d = 0; d < 10; d++) {
+        int predictedAs = 0;
+        int actual = 0;
+        for (int other = 0; other < 10; other++) {
+            predictedAs += report.confusion[other][d];
+            actual += report.confusion[d][other];
+        }
+        report.correct += report.confusion[d][d];
+        report.precision[d] = predictedAs > 0 ? static_cast<double>(report.confusion[d][d]) / predictedAs : 0.0;
+        report.recall[d] = actual > 0 ? static_cast<double>(report.confusion[d][d]) / actual : 0.0;
+    }
+
+    if (total > 0) {
+        report.accuracy = static_cast<double>(report.correct) / total;
+        report.meanConfidence = confidence / total;
+        report.imagesPerSecond = total / report.seconds;
+        report.latencyPerImageUs = computeSeconds * 1e6 / total;
+    }
+    return report;
+}
+
+std::future<EvaluationReport> Evaluator::EvaluateAsync(const NeuralNetwork& network, const std::vector<unsigned char>& images, const std::vector<int>& labels, ThreadPool& pool) {
+    return std::async(std::launch::async, [&network, &images, &labels, &pool] {
+        return Evaluate(network, images, labels, pool);
+    });
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <array>
+#include <future>
+#include <string>
+#include <vector>
+
+class NeuralNetwork;
+class ThreadPool;
+
+struct EvaluationReport {
+    int total = 0;
+    int correct = 0;
+    double accuracy = 0.0;
+    // confusion[actual][predicted]
+    std::array<std::array<int, 10>, 10> confusion{};
+    std::array<double, 10> precision{};
+    std::array<double, 10> recall{};
+    // Mean of the highest output over all images
+    double meanConfidence = 0.0;
+    int threads = 0;
+    double seconds = 0.0;
+    double imagesPerSecond = 0.0;
+    // Compute time per image inside a worker, unaffected by the number of threads
+    double latencyPerImageUs = 0.0;
+
+    void Print() const;
+    [[nodiscard]] std::string ToJson() const;
+};
+
+class Evaluator {
+public:
+    // images are count x 784 grayscale bytes as returned by MNISTloader::LoadImageBytes
+    static EvaluationReport Evaluate(const NeuralNetwork& network, const std::vector<unsigned char>& images, const std::vector<int>& labels, ThreadPool& pool);
+    // Runs Evaluate off the calling thread, the network must not be trained until the future is ready
+    static std::future<EvaluationReport> EvaluateAsync(const NeuralNetwork& network, const std::vector<unsigned char>& images, const std::vector<int>& labels, ThreadPool& pool);
+private:
+    static constexpr int chunkSize = 256;
+};
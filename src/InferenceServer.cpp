@@ -0,0 +1,328 @@
+#include "InferenceServer.h"
+#include "NeuralNetwork.h"
+
+#include <algorithm>
+#include <array>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace {
+    std::atomic<bool> stopRequested = false;
+
+    void RequestStop(int) {
+        stopRequested = true;
+    }
+
+#ifndef _WIN32
+    bool ReadFully(const int fd, void* data, const size_t size) {
+        auto* bytes = static_cast<char*>(data);
+        size_t done = 0;
+        while (done < size) {
+            const ssize_t n = read(fd, bytes + done, size - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += n;
+        }
+        return true;
+    }
+
+    bool WriteFully(const int fd, const void* data, const size_t size) {
+        const auto* bytes = static_cast<const char*>(data);
+        size_t done = 0;
+        while (done < size) {
+            const ssize_t n = write(fd, bytes + done, size - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += n;
+        }
+        return true;
+    }
+
+    int Connect(const std::string& socketPath) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+#endif
+}
+
+InferenceServer::InferenceServer(const NeuralNetwork& network, const int maxBatchSize, const int maxDelayMicroseconds)
+    : network(network), maxBatchSize(std::max(1, maxBatchSize)), maxDelay(std::max(0, maxDelayMicroseconds)) {}
+
+void InferenceServer::PrintLatencyReport(const std::string& prefix, std::vector<float>& latencies, const double seconds, long long requests) {
+    if (requests < 0) requests = static_cast<long long>(latencies.size());
+    if (latencies.empty()) {
+        std::cout << prefix << " 0 requests" << std::endl;
+        return;
+    }
+
+    auto percentile = [&](const double p) {
+        const auto index = static_cast<size_t>(p * static_cast<double>(latencies.size() - 1));
+        std::nth_element(latencies.begin(), latencies.begin() + static_cast<long>(index), latencies.end());
+        return latencies[index];
+    };
+    const float p50 = percentile(0.50);
+    const float p99 = percentile(0.99);
+
+    std::cout << prefix << " " << requests << " requests, " << static_cast<double>(requests) / seconds << " req/s, latency p50 "
+              << p50 << " us, p99 " << p99 << " us" << std::endl;
+}
+
+#ifdef _WIN32
+int InferenceServer::Serve(const std::string&, int, int) {
+    std::cerr << "[SERVER] Unix domain sockets are not supported on this platform" << std::endl;
+    return 1;
+}
+
+int InferenceServer::RunLoadGenerator(const std::string&, int, int, const std::vector<std::vector<float>>&) {
+    std::cerr << "[LOADGEN] Unix domain sockets are not supported on this platform" << std::endl;
+    return 1;
+}
+
+void InferenceServer::BatchLoop() {}
+void InferenceServer::HandleConnection(Connection&) {}
+void InferenceServer::Report(bool) {}
+#else
+int InferenceServer::Serve(const std::string& socketPath, const int reportSeconds, const int durationSeconds) {
+    sockaddr_un address{};
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "[SERVER] Socket path too long: " << socketPath << std::endl;
+        return 1;
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath.c_str());
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(listener, 64) < 0) {
+        std::cerr << "[SERVER] Cannot listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        if (listener >= 0) close(listener);
+        return 1;
+    }
+
+    std::signal(SIGINT, RequestStop);
+    std::signal(SIGTERM, RequestStop);
+    std::signal(SIGPIPE, SIG_IGN);
+    std::cout << "[SERVER] Listening on " << socketPath << " (max batch " << maxBatchSize << ", max delay " << maxDelay.count() << " us)" << std::endl;
+
+    const auto started = std::chrono::steady_clock::now();
+    reportStart = started;
+    std::thread batcher(&InferenceServer::BatchLoop, this);
+
+    while (!stopRequested) {
+        const auto now = std::chrono::steady_clock::now();
+        if (durationSeconds > 0 && now - started >= std::chrono::seconds(durationSeconds)) break;
+        if (reportSeconds > 0 && now - reportStart >= std::chrono::seconds(reportSeconds)) Report(false);
+
+        // Reap connections whose client hung up
+        std::erase_if(connections, [](Connection& c) {
+            if (!c.closed) return false;
+            c.thread.join();
+            close(c.fd);
+            return true;
+        });
+
+        pollfd pfd{listener, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) continue;
+
+        const int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) continue;
+        Connection& connection = connections.emplace_back();
+        connection.fd = fd;
+        connection.thread = std::thread(&InferenceServer::HandleConnection, this, std::ref(connection));
+    }
+
+    close(listener);
+    unlink(socketPath.c_str());
+    for (auto& connection : connections) {
+        shutdown(connection.fd, SHUT_RDWR);
+        connection.thread.join();
+        close(connection.fd);
+    }
+    connections.clear();
+    {
+        std::lock_guard lock(queueMutex);
+        stopping = true;
+    }
+    queueReady.notify_all();
+    batcher.join();
+
+    Report(true);
+    return 0;
+}
+
+void InferenceServer::BatchLoop() {
+    std::vector<Pending*> batch;
+    batch.reserve(maxBatchSize);
+    std::vector<unsigned char> inputs(static_cast<size_t>(maxBatchSize) * imageBytes);
+    std::vector<float> outputs(static_cast<size_t>(maxBatchSize) * 10);
+
+    while (true) {
+        {
+            std::unique_lock lock(queueMutex);
+            queueReady.wait(lock, [&] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+
+            // Hold the batch open until it is full or the oldest request waited long enough
+            const auto deadline = queue.front()->enqueued + maxDelay;
+            queueReady.wait_until(lock, deadline, [&] { return stopping || queue.size() >= static_cast<size_t>(maxBatchSize); });
+
+            const auto count = std::min(queue.size(), static_cast<size_t>(maxBatchSize));
+            batch.assign(queue.begin(), queue.begin() + static_cast<long>(count));
+            queue.erase(queue.begin(), queue.begin() + static_cast<long>(count));
+        }
+
+        const int count = static_cast<int>(batch.size());
+        for (int b = 0; b < count; b++) {
+            std::ranges::copy(batch[b]->input, inputs.begin() + static_cast<long>(b) * imageBytes);
+        }
+        network.FeedForwardBatch(inputs.data(), count, outputs.data());
+        for (int b = 0; b < count; b++) {
+            std::copy_n(outputs.begin() + static_cast<long>(b) * 10, 10, batch[b]->output.begin());
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard lock(statsMutex);
+            for (const Pending* pending : batch) {
+                const float latency = std::chrono::duration<float, std::micro>(now - pending->enqueued).count();
+                // The seen-th request of the window (0 based) replaces a random sample with probability max / (seen + 1)
+                const long long seen = batchedRequests++;
+                if (latencies.size() < maxLatencySamples) {
+                    latencies.push_back(latency);
+                }
+                else if (const auto slot = static_cast<size_t>(latencyRandom() % static_cast<unsigned long long>(seen + 1)); slot < maxLatencySamples) {
+                    latencies[slot] = latency;
+                }
+            }
+            batches++;
+        }
+        for (Pending* pending : batch) {
+            std::lock_guard lock(pending->mutex);
+            pending->done = true;
+            pending->finished.notify_one();
+        }
+    }
+}
+
+void InferenceServer::HandleConnection(Connection& connection) {
+    Pending pending;
+    std::array<char, responseBytes> response{};
+
+    while (ReadFully(connection.fd, pending.input.data(), pending.input.size())) {
+        pending.done = false;
+        pending.enqueued = std::chrono::steady_clock::now();
+        {
+            std::lock_guard lock(queueMutex);
+            queue.push_back(&pending);
+        }
+        queueReady.notify_one();
+        {
+            std::unique_lock lock(pending.mutex);
+            pending.finished.wait(lock, [&] { return pending.done; });
+        }
+
+        const int digit = static_cast<int>(std::distance(pending.output.begin(), std::ranges::max_element(pending.output)));
+        std::memcpy(response.data(), &digit, sizeof(int));
+        std::memcpy(response.data() + sizeof(int), pending.output.data(), 10 * sizeof(float));
+        if (!WriteFully(connection.fd, response.data(), response.size())) break;
+    }
+    connection.closed = true;
+}
+
+void InferenceServer::Report(const bool final) {
+    std::vector<float> window;
+    long long windowBatches;
+    long long windowRequests;
+    const auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard lock(statsMutex);
+        window.swap(latencies);
+        windowBatches = batches;
+        windowRequests = batchedRequests;
+        batches = 0;
+        batchedRequests = 0;
+    }
+    const double seconds = std::chrono::duration<double>(now - reportStart).count();
+    reportStart = now;
+
+    if (window.empty() && !final) return;
+    const double meanBatch = windowBatches > 0 ? static_cast<double>(windowRequests) / static_cast<double>(windowBatches) : 0.0;
+    std::cout << "[SERVER] Mean batch size: " << meanBatch << " (" << windowBatches << " batches)" << std::endl;
+    PrintLatencyReport(final ? "[SERVER] Final:" : "[SERVER]", window, seconds, windowRequests);
+}
+
+int InferenceServer::RunLoadGenerator(const std::string& socketPath, const int clients, const int requests, const std::vector<std::vector<float>>& images) {
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::vector<std::vector<float>> clientLatencies(clients);
+    std::atomic<int> failures = 0;
+    std::vector<std::thread> threads;
+    threads.reserve(clients);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < clients; c++) {
+        threads.emplace_back([&, c] {
+            const int fd = Connect(socketPath);
+            if (fd < 0) {
+                failures++;
+                return;
+            }
+
+            // Dataset images when given, otherwise random pixels from a fixed per-client seed
+            std::mt19937 gen(1234 + c);
+            std::uniform_int_distribution pixel(0, 255);
+            std::array<unsigned char, imageBytes> request{};
+            std::array<char, responseBytes> response{};
+            clientLatencies[c].reserve(requests);
+
+            for (int r = 0; r < requests; r++) {
+                if (!images.empty()) {
+                    const auto& image = images[(static_cast<size_t>(c) * requests + r) % images.size()];
+                    for (int i = 0; i < imageBytes; i++) request[i] = static_cast<unsigned char>(image[i] * 255.0f);
+                }
+                else {
+                    for (auto& value : request) value = static_cast<unsigned char>(pixel(gen));
+                }
+
+                const auto sent = std::chrono::steady_clock::now();
+                if (!WriteFully(fd, request.data(), request.size()) || !ReadFully(fd, response.data(), response.size())) {
+                    failures++;
+                    break;
+                }
+                clientLatencies[c].push_back(std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - sent).count());
+            }
+            close(fd);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<float> all;
+    for (const auto& latencies : clientLatencies) all.insert(all.end(), latencies.begin(), latencies.end());
+    PrintLatencyReport("[LOADGEN] " + std::to_string(clients) + " client(s):", all, seconds);
+    if (failures > 0) {
+        std::cerr << "[LOADGEN] " << failures << " client(s) failed, is the server running on " << socketPath << "?" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+#endif
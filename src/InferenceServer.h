@@ -0,0 +1,74 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+class NeuralNetwork;
+
+// Serves digit recognition over a Unix domain socket. Every request is 784 grayscale bytes (28x28),
+// every response is the predicted digit as int32 followed by the 10 output probabilities as float.
+// Requests of concurrent connections are grouped into micro-batches of at most maxBatchSize images,
+// the first request of a batch waits at most maxDelayMicroseconds for others to arrive.
+class InferenceServer {
+public:
+    static constexpr int imageBytes = 784;
+    static constexpr int responseBytes = sizeof(int) + 10 * sizeof(float);
+
+    InferenceServer(const NeuralNetwork& network, int maxBatchSize, int maxDelayMicroseconds);
+
+    // Blocks until SIGINT/SIGTERM or until durationSeconds passed (0 runs forever)
+    int Serve(const std::string& socketPath, int reportSeconds, int durationSeconds);
+    static int RunLoadGenerator(const std::string& socketPath, int clients, int requests, const std::vector<std::vector<float>>& images);
+
+    // Prints "<prefix> n requests, x req/s, latency p50 / p99" from latencies in microseconds. requests is the
+    // number of requests the latencies were sampled from, by default all of them are in latencies.
+    static void PrintLatencyReport(const std::string& prefix, std::vector<float>& latencies, double seconds, long long requests = -1);
+
+    // Latencies kept per report window, a uniform sample of the window once more requests arrived
+    static constexpr size_t maxLatencySamples = 1 << 16;
+private:
+    struct Pending {
+        std::array<unsigned char, imageBytes> input{};
+        std::array<float, 10> output{};
+        std::chrono::steady_clock::time_point enqueued;
+        bool done = false;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    struct Connection {
+        int fd = -1;
+        std::thread thread;
+        std::atomic<bool> closed = false;
+    };
+
+    void BatchLoop();
+    void HandleConnection(Connection& connection);
+    void Report(bool final);
+
+    const NeuralNetwork& network;
+    int maxBatchSize;
+    std::chrono::microseconds maxDelay;
+
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::deque<Pending*> queue;
+    bool stopping = false;
+
+    std::mutex statsMutex;
+    // Reservoir sample of the window: without periodic reports a long running server would otherwise grow it forever
+    std::vector<float> latencies;
+    std::minstd_rand latencyRandom{12345};
+    long long batches = 0;
+    long long batchedRequests = 0;
+    std::chrono::steady_clock::time_point reportStart;
+
+    std::list<Connection> connections;
+};
@@ -0,0 +1,88 @@
+#include "LiveInference.h"
+#include "NeuralNetwork.h"
+
+#include <algorithm>
+
+LiveInference::LiveInference(const NeuralNetwork& network, const int fullRecomputeInterval)
+    : network(network), fullRecomputeInterval(std::max(1, fullRecomputeInterval)) {
+    Synchronize();
+}
+
+void LiveInference::Synchronize() {
+    inputSize = network.inputSize;
+    hiddenSize = network.hiddenSize;
+    outputSize = network.outputSize;
+
+    weightsByPixel.resize(static_cast<size_t>(inputSize) * hiddenSize);
+    for (int h = 0; h < hiddenSize; h++) {
+        for (int i = 0; i < inputSize; i++) {
+            weightsByPixel[static_cast<size_t>(i) * hiddenSize + h] = network.W1[h][i];
+        }
+    }
+    preActivations.assign(hiddenSize, 0.0f);
+    hidden.assign(hiddenSize, 0.0f);
+    previousInput.assign(inputSize, 0.0f);
+    outputs.assign(outputSize, 0.0f);
+    changed.resize(inputSize);
+    valid = false;
+}
+
+void LiveInference::Update(const float* input) {
+    int count = 0;
+    for (int i = 0; i < inputSize; i++) {
+        if (input[i] != previousInput[i]) changed[count++] = i;
+    }
+    changedPixels = count;
+
+    // A delta costs hiddenSize multiply-adds per pixel like the full pass, which streams W1 far more efficiently
+    const bool full = !valid || updatesSinceFull >= fullRecomputeInterval || count > inputSize / 4;
+    lastUpdateFull = full;
+    if (full) {
+        FullRecompute(input);
+    }
+    else if (count > 0) {
+        for (int c = 0; c < count; c++) {
+            const int i = changed[c];
+            const float delta = input[i] - previousInput[i];
+            const float* column = weightsByPixel.data() + static_cast<size_t>(i) * hiddenSize;
+            for (int h = 0; h < hiddenSize; h++) {
+                preActivations[h] += column[h] * delta;
+            }
+            previousInput[i] = input[i];
+        }
+        updatesSinceFull++;
+    }
+    else {
+        return;
+    }
+    UpdateOutputs();
+}
+
+void LiveInference::FullRecompute(const float* input) {
+    std::copy_n(network.b1.begin(), hiddenSize, preActivations.begin());
+    for (int i = 0; i < inputSize; i++) {
+        const float x = input[i];
+        previousInput[i] = x;
+        if (x == 0.0f) continue;
+        const float* column = weightsByPixel.data() + static_cast<size_t>(i) * hiddenSize;
+        for (int h = 0; h < hiddenSize; h++) {
+            preActivations[h] += column[h] * x;
+        }
+    }
+    valid = true;
+    updatesSinceFull = 0;
+}
+
+void LiveInference::UpdateOutputs() {
+    for (int h = 0; h < hiddenSize; h++) {
+        hidden[h] = NeuralNetwork::sigmoid(preActivations[h]);
+    }
+    for (int o = 0; o < outputSize; o++) {
+        float sum = network.b2[o];
+        for (int h = 0; h < hiddenSize; h++) {
+            sum += network.W2[o][h] * hidden[h];
+        }
+        outputs[o] = NeuralNetwork::sigmoid(sum);
+    }
+    prediction = static_cast<int>(std::ranges::max_element(outputs) - outputs.begin());
+}
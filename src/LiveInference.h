@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+
+class NeuralNetwork;
+
+// Prediction that follows the drawing every frame: the hidden pre-activations are kept and only the input pixels
+// that changed since the last update are applied (z += W1[:, i] * dx_i), then the small output layer is recomputed.
+// A full first layer pass runs on the first update, every fullRecomputeInterval updates to bound the float drift,
+// and when so many pixels changed that the full pass is cheaper.
+class LiveInference {
+public:
+    explicit LiveInference(const NeuralNetwork& network, int fullRecomputeInterval = 64);
+
+    // Copies the weights again, call it after the network was trained or loaded
+    void Synchronize();
+    // input holds inputSize floats
+    void Update(const float* input);
+
+    [[nodiscard]] const std::vector<float>& Outputs() const { return outputs; }
+    [[nodiscard]] int Prediction() const { return prediction; }
+    [[nodiscard]] int ChangedPixels() const { return changedPixels; }
+    [[nodiscard]] bool LastUpdateWasFull() const { return lastUpdateFull; }
+private:
+    void FullRecompute(const float* input);
+    void UpdateOutputs();
+
+    const NeuralNetwork& network;
+    int fullRecomputeInterval;
+    int inputSize = 0;
+    int hiddenSize = 0;
+    int outputSize = 0;
+
+    // W1 transposed (inputSize x hiddenSize) so the column of a changed pixel is contiguous
+    std::vector<float> weightsByPixel;
+    std::vector<float> preActivations;
+    std::vector<float> hidden;
+    std::vector<float> previousInput;
+    std::vector<float> outputs;
+    std::vector<int> changed;
+
+    bool valid = false;
+    int updatesSinceFull = 0;
+    int changedPixels = 0;
+    bool lastUpdateFull = false;
+    int prediction = 0;
+};
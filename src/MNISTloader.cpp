@@ -1,6 +1,7 @@
 #include "MNISTloader.h"
 
 #include <fstream>
+#include <istream>
 #include <vector>
 #include <stdexcept>
 
@@ -12,24 +13,33 @@ int MNISTloader::ReverseInt(const int i) {
     return (static_cast<int>(c1) << 24) + (static_cast<int>(c2) << 16) + (static_cast<int>(c3) << 8) + c4;
 }
 
-std::vector<std::vector<float>> MNISTloader::LoadImages(const std::string &filename) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file) throw std::runtime_error("[MNISTloader] Cannot open file: " + filename);
-
+int MNISTloader::ReadImageHeader(std::istream& file, const std::string& filename) {
     int magic_number = 0, number_of_images = 0, n_rows = 0, n_cols = 0;
     file.read(reinterpret_cast<char*>(&magic_number), sizeof(magic_number));
     file.read(reinterpret_cast<char*>(&number_of_images), sizeof(number_of_images));
     file.read(reinterpret_cast<char*>(&n_rows), sizeof(n_rows));
     file.read(reinterpret_cast<char*>(&n_cols), sizeof(n_cols));
+    if (!file) throw std::runtime_error("[MNISTloader] Truncated header: " + filename);
 
     magic_number = ReverseInt(magic_number);
     number_of_images = ReverseInt(number_of_images);
     n_rows = ReverseInt(n_rows);
     n_cols = ReverseInt(n_cols);
+    if (n_rows != 28 || n_cols != 28 || number_of_images < 0) {
+        throw std::runtime_error("[MNISTloader] Expected 28x28 images, got " + std::to_string(n_rows) + "x" + std::to_string(n_cols) + ": " + filename);
+    }
+    return number_of_images;
+}
 
-    std::vector images(number_of_images, std::vector<float>(n_rows * n_cols));
+std::vector<std::vector<float>> MNISTloader::LoadImages(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) throw std::runtime_error("[MNISTloader] Cannot open file: " + filename);
+
+    const int number_of_images = ReadImageHeader(file, filename);
+
+    std::vector images(number_of_images, std::vector<float>(imagePixels));
     for (int i = 0; i < number_of_images; ++i) {
-        for (int j = 0; j < n_rows * n_cols; ++j) {
+        for (int j = 0; j < imagePixels; ++j) {
             unsigned char pixel = 0;
             file.read(reinterpret_cast<char*>(&pixel), sizeof(pixel));
             images[i][j] = static_cast<float>(pixel) / 255.0f;
@@ -38,6 +48,18 @@ std::vector<std::vector<float>> MNISTloader::LoadImages(const std::string &filen
     return images;
 }
 
+std::vector<unsigned char> MNISTloader::LoadImageBytes(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) throw std::runtime_error("[MNISTloader] Cannot open file: " + filename);
+
+    const int number_of_images = ReadImageHeader(file, filename);
+
+    std::vector<unsigned char> pixels(static_cast<size_t>(number_of_images) * imagePixels);
+    file.read(reinterpret_cast<char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+    if (file.gcount() != static_cast<std::streamsize>(pixels.size())) throw std::runtime_error("[MNISTloader] Truncated file: " + filename);
+    return pixels;
+}
+
 std::vector<int> MNISTloader::LoadLabels(const std::string &filename) {
     std::ifstream file(filename, std::ios::binary);
     if (!file) throw std::runtime_error("[MNISTloader] Cannot open file: " + filename);
@@ -1,4 +1,5 @@
 #pragma once
+#include <iosfwd>
 #include <vector>
 #include <string>
 
@@ -6,5 +7,13 @@ class MNISTloader {
 public:
     static int ReverseInt(int i);
     static std::vector<std::vector<float>> LoadImages(const std::string &filename);
+    // All images as one contiguous count x rows * cols block of raw grayscale bytes
+    static std::vector<unsigned char> LoadImageBytes(const std::string &filename);
     static std::vector<int> LoadLabels(const std::string &filename);
+
+    // Every loader assumes this many pixels (28x28) per image
+    static constexpr int imagePixels = 784;
+private:
+    // Reads the idx3 header, returns the image count. Throws for a truncated header or images that are not 28x28.
+    static int ReadImageHeader(std::istream& file, const std::string& filename);
 };
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "NeuralNetwork.h"
+#include "Profiler.h"
+#include "PerfCounters.h"
 #include <cmath>
 #include <iostream>
 #include <ostream>
@@ -6,10 +8,18 @@
 #include <filesystem>
 #include <float.h>
 #include <random>
-#include "TimerChrono.h"
-
-NeuralNetwork::NeuralNetwork(const int inputSize, const int hiddenSize, const int outputSize) : inputSize(inputSize), hiddenSize(hiddenSize), outputSize(outputSize) {
-    std::mt19937 gen(std::random_device{}());
+#include <sstream>
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <thread>
+#include <type_traits>
+
+NeuralNetwork::NeuralNetwork(const int inputSize, const int hiddenSize, const int outputSize)
+    : NeuralNetwork(inputSize, hiddenSize, outputSize, std::random_device{}()) {}
+
+NeuralNetwork::NeuralNetwork(const int inputSize, const int hiddenSize, const int outputSize, const unsigned int seed) : inputSize(inputSize), hiddenSize(hiddenSize), outputSize(outputSize) {
+    std::mt19937 gen(seed);
     std::uniform_real_distribution dist(-1.0f, 1.0f);
 
     W1.resize(hiddenSize, std::vector<float>(inputSize));
@@ -17,11 +27,6 @@ NeuralNetwork::NeuralNetwork(const int inputSize, const int hiddenSize, const in
     b1.resize(hiddenSize);
     b2.resize(outputSize);
 
-    dW1.resize(hiddenSize, std::vector<float>(inputSize));
-    dW2.resize(outputSize, std::vector<float>(hiddenSize));
-    dB1.resize(hiddenSize);
-    dB2.resize(outputSize);
-
     for (auto& row : W1) {
         for (auto& val : row) {
             val = dist(gen);
@@ -63,10 +68,10 @@ void NeuralNetwork::SaveNetwork(const std::string& filePath) const {
     std::cout << "[N.N. SAVE] Neural network saved in: " << filePath << std::endl;
 }
 
-void NeuralNetwork::LoadNetwork(const std::string& filePath) {
+bool NeuralNetwork::LoadNetwork(const std::string& filePath) {
     if (!std::filesystem::exists(filePath)) {
         std::cerr << "[N.N. LOAD] Could not find file: " << filePath << std::endl;
-        return;
+        return false;
     }
 
     std::ifstream in(filePath, std::ios::binary);
@@ -75,26 +80,47 @@ void NeuralNetwork::LoadNetwork(const std::string& filePath) {
         exit(-1);
     }
 
-    in.read(reinterpret_cast<char*>(&currentEpoch), sizeof(int));
+    int epoch = 0;
+    in.read(reinterpret_cast<char*>(&epoch), sizeof(int));
 
-    int is, hs, os;
+    int is = 0, hs = 0, os = 0;
     in.read(reinterpret_cast<char*>(&is), sizeof(int));
     in.read(reinterpret_cast<char*>(&hs), sizeof(int));
     in.read(reinterpret_cast<char*>(&os), sizeof(int));
+    if (!in || is != inputSize || hs != hiddenSize || os != outputSize) {
+        std::cerr << "[N.N. LOAD] " << filePath << " holds a " << is << "-" << hs << "-" << os << " network, expected "
+                  << inputSize << "-" << hiddenSize << "-" << outputSize << std::endl;
+        return false;
+    }
 
+    // Read into copies so a truncated file leaves the current weights untouched
+    auto loadedW1 = W1;
+    auto loadedW2 = W2;
+    auto loadedB1 = b1;
+    auto loadedB2 = b2;
     for (int h = 0; h < hiddenSize; h++) {
-        in.read(reinterpret_cast<char*>(W1[h].data()), static_cast<std::streamsize>(inputSize * sizeof(float)));
+        in.read(reinterpret_cast<char*>(loadedW1[h].data()), static_cast<std::streamsize>(inputSize * sizeof(float)));
     }
     for (int o = 0; o < outputSize; o++) {
-        in.read(reinterpret_cast<char*>(W2[o].data()), static_cast<std::streamsize>(hiddenSize * sizeof(float)));
+        in.read(reinterpret_cast<char*>(loadedW2[o].data()), static_cast<std::streamsize>(hiddenSize * sizeof(float)));
     }
 
-    in.read(reinterpret_cast<char*>(b1.data()), static_cast<std::streamsize>(hiddenSize * sizeof(float)));
-    in.read(reinterpret_cast<char*>(b2.data()), static_cast<std::streamsize>(outputSize * sizeof(float)));
-
+    in.read(reinterpret_cast<char*>(loadedB1.data()), static_cast<std::streamsize>(hiddenSize * sizeof(float)));
+    in.read(reinterpret_cast<char*>(loadedB2.data()), static_cast<std::streamsize>(outputSize * sizeof(float)));
+    if (!in) {
+        std::cerr << "[N.N. LOAD] " << filePath << " is truncated" << std::endl;
+        return false;
+    }
     in.close();
+
+    currentEpoch = epoch;
+    W1 = std::move(loadedW1);
+    W2 = std::move(loadedW2);
+    b1 = std::move(loadedB1);
+    b2 = std::move(loadedB2);
     std::cout << "[N.N. LOAD] Neural network loaded from: " << filePath << std::endl;
     std::cout << "[N.N. LOAD] Loaded neural network currently has " << currentEpoch << " epochs!" << std::endl;
+    return true;
 }
 
 float NeuralNetwork::sigmoid(const float x) {
@@ -122,8 +148,8 @@ std::vector<std::vector<float>> NeuralNetwork::ActivationHeatMap(const std::vect
         }
     }
 
-    float minValue;
-    float maxValue;
+    float minValue = FLT_MAX;
+    float maxValue = -FLT_MAX;
     for (auto& row : heat) {
         for (float v : row) {
             minValue = std::min(minValue, v);
@@ -200,39 +226,198 @@ std::vector<float> NeuralNetwork::FeedForward(const std::vector<float>& input) c
     return output;
 }
 
-void NeuralNetwork::ResetGradients() {
-    for (auto& row : dW1) std::ranges::fill(row, 0.0f);
-    for (auto& row : dW2) std::ranges::fill(row, 0.0f);
-    std::ranges::fill(dB1, 0.0f);
-    std::ranges::fill(dB2, 0.0f);
+template <typename T>
+void NeuralNetwork::FeedForwardRange(const T* inputs, const int begin, const int end, float* outputs) const {
+    PROFILE_ZONE("inference");
+    // Tiles of images share every W1 row while it is in registers/L1, the 8 lane accumulators
+    // keep the dot products vectorizable without reassociating float sums
+    constexpr int tileImages = 4;
+    constexpr int lanes = 8;
+
+    // Per thread scratch that only ever grows, steady state inference does not allocate
+    thread_local std::vector<float> workspace;
+    const size_t workspaceSize = static_cast<size_t>(tileImages) * (inputSize + hiddenSize);
+    if (workspace.size() < workspaceSize) workspace.resize(workspaceSize);
+    float* converted = workspace.data();
+    float* hidden = workspace.data() + static_cast<size_t>(tileImages) * inputSize;
+
+    for (int n = begin; n < end; n += tileImages) {
+        const int count = std::min(tileImages, end - n);
+
+        const float* x[tileImages];
+        for (int t = 0; t < tileImages; t++) {
+            const int image = n + std::min(t, count - 1);
+            if constexpr (std::is_same_v<T, float>) {
+                x[t] = inputs + static_cast<size_t>(image) * inputSize;
+            }
+            else {
+                float* dst = converted + static_cast<size_t>(t) * inputSize;
+                const T* src = inputs + static_cast<size_t>(image) * inputSize;
+                for (int i = 0; i < inputSize; i++) dst[i] = static_cast<float>(src[i]) * (1.0f / 255.0f);
+                x[t] = dst;
+            }
+        }
+
+        for (int h = 0; h < hiddenSize; h++) {
+            const float* w = W1[h].data();
+            float acc[tileImages][lanes] = {};
+
+            int i = 0;
+            for (; i + lanes <= inputSize; i += lanes) {
+                for (int t = 0; t < tileImages; t++) {
+                    for (int l = 0; l < lanes; l++) {
+                        acc[t][l] += w[i + l] * x[t][i + l];
+                    }
+                }
+            }
+            for (int t = 0; t < tileImages; t++) {
+                float sum = b1[h];
+                for (int l = 0; l < lanes; l++) sum += acc[t][l];
+                for (int r = i; r < inputSize; r++) sum += w[r] * x[t][r];
+                hidden[t * hiddenSize + h] = sigmoid(sum);
+            }
+        }
+
+        for (int t = 0; t < count; t++) {
+            float* output = outputs + static_cast<size_t>(n + t) * outputSize;
+            for (int o = 0; o < outputSize; o++) {
+                float sum = b2[o];
+                for (int h = 0; h < hiddenSize; h++) {
+                    sum += W2[o][h] * hidden[t * hiddenSize + h];
+                }
+                output[o] = sigmoid(sum);
+            }
+        }
+    }
+}
+
+template <typename T>
+void NeuralNetwork::FeedForwardParallel(const T* inputs, const int count, float* outputs, int threads) const {
+    // Not worth a thread for less than a few hundred images
+    constexpr int minImagesPerThread = 256;
+    threads = std::clamp(std::min(threads, count / minImagesPerThread), 1, 256);
+    if (threads == 1) {
+        FeedForwardRange(inputs, 0, count, outputs);
+        return;
+    }
+
+    const int chunk = (count + threads - 1) / threads;
+    std::vector<std::jthread> workers;
+    workers.reserve(threads);
+    for (int t = 0; t < threads; t++) {
+        const int begin = t * chunk;
+        const int end = std::min(begin + chunk, count);
+        if (begin >= end) break;
+        workers.emplace_back([this, inputs, outputs, begin, end] {
+            FeedForwardRange(inputs, begin, end, outputs);
+        });
+    }
+}
+
+void NeuralNetwork::FeedForwardBatch(const float* inputs, const int count, float* outputs, const int threads) const {
+    FeedForwardParallel(inputs, count, outputs, threads);
+}
+
+void NeuralNetwork::FeedForwardBatch(const unsigned char* inputs, const int count, float* outputs, const int threads) const {
+    FeedForwardParallel(inputs, count, outputs, threads);
 }
 
-void NeuralNetwork::AccumulateGradient(const std::vector<float>& X, const std::vector<float>& Y) {
+std::vector<float> NeuralNetwork::FeedForwardBatch(const std::vector<float>& inputs, const int threads) const {
+    const int count = static_cast<int>(inputs.size() / inputSize);
+    std::vector<float> outputs(static_cast<size_t>(count) * outputSize);
+    FeedForwardParallel(inputs.data(), count, outputs.data(), threads);
+    return outputs;
+}
+
+std::vector<float> NeuralNetwork::FeedForwardBatch(const std::vector<unsigned char>& inputs, const int threads) const {
+    const int count = static_cast<int>(inputs.size() / inputSize);
+    std::vector<float> outputs(static_cast<size_t>(count) * outputSize);
+    FeedForwardParallel(inputs.data(), count, outputs.data(), threads);
+    return outputs;
+}
+
+NeuralNetwork::Gradients NeuralNetwork::MakeGradients() const {
+    Gradients gradients;
+    gradients.dW1.resize(hiddenSize, std::vector<float>(inputSize));
+    gradients.dW2.resize(outputSize, std::vector<float>(hiddenSize));
+    gradients.dB1.resize(hiddenSize);
+    gradients.dB2.resize(outputSize);
+    gradients.hidden.resize(hiddenSize);
+    gradients.output.resize(outputSize);
+    gradients.deltaOut.resize(outputSize);
+    gradients.deltaHid.resize(hiddenSize);
+    return gradients;
+}
+
+void NeuralNetwork::ResetGradients(Gradients& gradients) {
+    for (auto& row : gradients.dW1) std::ranges::fill(row, 0.0f);
+    for (auto& row : gradients.dW2) std::ranges::fill(row, 0.0f);
+    std::ranges::fill(gradients.dB1, 0.0f);
+    std::ranges::fill(gradients.dB2, 0.0f);
+    gradients.loss = 0.0;
+    gradients.correct = 0;
+}
+
+void NeuralNetwork::AddGradients(Gradients& into, const Gradients& from) {
+    for (size_t h = 0; h < into.dW1.size(); h++) {
+        for (size_t i = 0; i < into.dW1[h].size(); i++) {
+            into.dW1[h][i] += from.dW1[h][i];
+        }
+    }
+    for (size_t o = 0; o < into.dW2.size(); o++) {
+        for (size_t h = 0; h < into.dW2[o].size(); h++) {
+            into.dW2[o][h] += from.dW2[o][h];
+        }
+    }
+    for (size_t h = 0; h < into.dB1.size(); h++) {
+        into.dB1[h] += from.dB1[h];
+    }
+    for (size_t o = 0; o < into.dB2.size(); o++) {
+        into.dB2[o] += from.dB2[o];
+    }
+    into.loss += from.loss;
+    into.correct += from.correct;
+}
+
+void NeuralNetwork::AccumulateGradient(const std::vector<float>& X, const std::vector<float>& Y, Gradients& gradients) const {
     const auto& input = X;
     const auto& target = Y;
 
-    std::vector<float> hidden(hiddenSize);
-    std::vector<float> output(outputSize);
+    auto& hidden = gradients.hidden;
+    auto& output = gradients.output;
 
-    for (int h = 0; h < hiddenSize; h++) {
-        float sum = b1[h];
-        for (int i = 0; i < inputSize; i++)
-            sum += W1[h][i] * input[i];
-        hidden[h] = sigmoid(sum);
-    }
+    {
+        PROFILE_ZONE("forward");
+        for (int h = 0; h < hiddenSize; h++) {
+            float sum = b1[h];
+            for (int i = 0; i < inputSize; i++)
+                sum += W1[h][i] * input[i];
+            hidden[h] = sigmoid(sum);
+        }
 
-    for (int o = 0; o < outputSize; o++) {
-        float sum = b2[o];
-        for (int h = 0; h < hiddenSize; h++)
-            sum += W2[o][h] * hidden[h];
-        output[o] = sigmoid(sum);
+        for (int o = 0; o < outputSize; o++) {
+            float sum = b2[o];
+            for (int h = 0; h < hiddenSize; h++)
+                sum += W2[o][h] * hidden[h];
+            output[o] = sigmoid(sum);
+        }
     }
 
-    std::vector<float> deltaOut(outputSize);
+    PROFILE_ZONE("backward");
+    // Loss and accuracy come from the output error the backward pass needs anyway
+    auto& deltaOut = gradients.deltaOut;
+    float loss = 0.0f;
+    int predicted = 0, expected = 0;
     for (int o = 0; o < outputSize; o++) {
-        deltaOut[o] = (output[o] - target[o]) * sigmoidDerivative(output[o]);
-    }
-    std::vector deltaHid(hiddenSize, 0.0f);
+        const float error = output[o] - target[o];
+        deltaOut[o] = error * sigmoidDerivative(output[o]);
+        loss += error * error;
+        if (output[o] > output[predicted]) predicted = o;
+        if (target[o] > target[expected]) expected = o;
+    }
+    gradients.loss += 0.5 * loss;
+    gradients.correct += predicted == expected ? 1 : 0;
+    auto& deltaHid = gradients.deltaHid;
     for (int h = 0; h < hiddenSize; h++) {
         float sum = 0;
         for (int o = 0; o < outputSize; o++)
@@ -242,58 +427,189 @@ void NeuralNetwork::AccumulateGradient(const std::vector<float>& X, const std::v
 
     for (int o = 0; o < outputSize; o++) {
         for (int h = 0; h < hiddenSize; h++) {
-            dW2[o][h] += deltaOut[o] * hidden[h];
+            gradients.dW2[o][h] += deltaOut[o] * hidden[h];
         }
     }
     for (int h = 0; h < hiddenSize; h++) {
         for (int i = 0; i < inputSize; i++) {
-            dW1[h][i] += deltaHid[h] * input[i];
+            gradients.dW1[h][i] += deltaHid[h] * input[i];
         }
     }
     for (int o = 0; o < outputSize; o++) {
-        dB2[o] += deltaOut[o];
+        gradients.dB2[o] += deltaOut[o];
     }
     for (int h = 0; h < hiddenSize; h++) {
-        dB1[h] += deltaHid[h];
+        gradients.dB1[h] += deltaHid[h];
     }
 }
 
-void NeuralNetwork::ApplyGradient(const int batchSize, const float learningRate) {
+void NeuralNetwork::ApplyGradient(const Gradients& gradients, const int batchSize, const float learningRate) {
+    PROFILE_ZONE("update");
     const float scale = learningRate / static_cast<float>(batchSize);
 
     for (int h = 0; h < hiddenSize; h++) {
         for (int i = 0; i < inputSize; i++) {
-            W1[h][i] -= scale * dW1[h][i];
+            W1[h][i] -= scale * gradients.dW1[h][i];
         }
     }
     for (int o = 0; o < outputSize; o++) {
         for (int h = 0; h < hiddenSize; h++) {
-            W2[o][h] -= scale * dW2[o][h];
+            W2[o][h] -= scale * gradients.dW2[o][h];
         }
     }
     for (int h = 0; h < hiddenSize; h++) {
-        b1[h] -= scale * dB1[h];
+        b1[h] -= scale * gradients.dB1[h];
     }
     for (int o = 0; o < outputSize; o++) {
-        b2[o] -= scale * dB2[o];
+        b2[o] -= scale * gradients.dB2[o];
     }
 }
 
-void NeuralNetwork::TrainNetwork(const std::vector<std::vector<float>>& X, const std::vector<std::vector<float>>& Y, const float learningRate, const int epochs) {
-    for (int epoch = 0; epoch < epochs; epoch++) {
-        constexpr int batchSize = 64;
+std::string TrainingProgress::ToLine() const {
+    std::ostringstream line;
+    line << "epoch=" << epoch << " epochs=" << epochs << " total_epochs=" << totalEpochs << " samples=" << samples
+         << " samples_per_epoch=" << samplesPerEpoch << " loss=" << loss << " accuracy=" << accuracy
+         << " samples_per_second=" << samplesPerSecond << " elapsed_seconds=" << elapsedSeconds << " eta_seconds=" << etaSeconds
+         << " epoch_done=" << (epochDone ? 1 : 0);
+    return line.str();
+}
+
+void NeuralNetwork::SetProgressCallback(std::function<void(const TrainingProgress&)> callback, const int reportEveryBatches) {
+    progressCallback = std::move(callback);
+    progressInterval = std::max(1, reportEveryBatches);
+}
+
+void NeuralNetwork::TrainNetwork(const std::vector<std::vector<float>>& X, const std::vector<std::vector<float>>& Y, const float learningRate, const int epochs,
+                                 int threads, const std::string& savePath) {
+    constexpr int batchSize = 64;
+    const int total = static_cast<int>(X.size());
+    threads = std::clamp(threads, 1, batchSize);
+
+    // One gradient buffer per worker, partials[0] also receives the reduced batch gradient
+    std::vector<Gradients> partials(threads, MakeGradients());
+
+    const auto trainStart = std::chrono::steady_clock::now();
+    TrainingProgress progress;
+    progress.epochs = epochs;
+    progress.samplesPerEpoch = total;
+    double epochLoss = 0.0;
+    long long epochCorrect = 0;
+    int batchIndex = 0;
+
+    auto report = [&](const bool epochDone) {
+        progress.totalEpochs = currentEpoch;
+        progress.loss = progress.samples > 0 ? epochLoss / static_cast<double>(progress.samples) : 0.0;
+        progress.accuracy = progress.samples > 0 ? static_cast<double>(epochCorrect) / static_cast<double>(progress.samples) : 0.0;
+        progress.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - trainStart).count();
+        const double done = static_cast<double>(progress.epoch - 1) * static_cast<double>(total) + static_cast<double>(progress.samples);
+        progress.samplesPerSecond = progress.elapsedSeconds > 0.0 ? done / progress.elapsedSeconds : 0.0;
+        progress.etaSeconds = progress.samplesPerSecond > 0.0 ? (static_cast<double>(epochs) * total - done) / progress.samplesPerSecond : 0.0;
+        progress.epochDone = epochDone;
+        if (progressCallback) progressCallback(progress);
+    };
+    // Runs once per batch on the thread that applies the gradient
+    auto recordBatch = [&](const Gradients& batch, const int realBatchSize) {
+        epochLoss += batch.loss;
+        epochCorrect += batch.correct;
+        progress.samples += realBatchSize;
+        if (progressCallback && ++batchIndex % progressInterval == 0) report(false);
+    };
 
-        for (int n = 0; n < X.size(); n += batchSize) {
-            ResetGradients();
-            const int realBatchSize = std::min(batchSize, static_cast<int>(X.size()) - n);
-            for (int b = 0; b < realBatchSize; b++) {
-                AccumulateGradient(X[n + b], Y[n + b]);
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        PROFILE_ZONE("epoch");
+        progress.epoch = epoch + 1;
+        progress.samples = 0;
+        epochLoss = 0.0;
+        epochCorrect = 0;
+        batchIndex = 0;
+        // Counters are per thread, every worker adds what it counted between its first and last batch
+        std::vector<PerfCounters::Values> epochCounters(threads);
+        std::vector<int> counted(threads, 0);
+        const auto epochStart = std::chrono::steady_clock::now();
+
+        if (threads == 1) {
+            PerfCounters::Values start;
+            const bool counting = PerfCounters::Read(start);
+            for (int n = 0; n < total; n += batchSize) {
+                PROFILE_ZONE("batch");
+                const int realBatchSize = std::min(batchSize, total - n);
+                {
+                    PROFILE_ZONE("reset");
+                    ResetGradients(partials[0]);
+                }
+                for (int b = 0; b < realBatchSize; b++) {
+                    AccumulateGradient(X[n + b], Y[n + b], partials[0]);
+                }
+                ApplyGradient(partials[0], realBatchSize, learningRate);
+                recordBatch(partials[0], realBatchSize);
+            }
+            if (counting && PerfCounters::Read(epochCounters[0])) {
+                epochCounters[0] = epochCounters[0] - start;
+                counted[0] = 1;
+            }
+        }
+        else {
+            // Every worker walks the same batch sequence, the barrier completion reduces and applies
+            // the gradients once all workers are done with their slice of the current batch
+            int batchStart = 0;
+            auto reduceAndApply = [&]() noexcept {
+                {
+                    PROFILE_ZONE("reduce");
+                    for (int t = 1; t < threads; t++) {
+                        AddGradients(partials[0], partials[t]);
+                    }
+                }
+                const int realBatchSize = std::min(batchSize, total - batchStart);
+                ApplyGradient(partials[0], realBatchSize, learningRate);
+                recordBatch(partials[0], realBatchSize);
+                batchStart += batchSize;
+            };
+            std::barrier sync(threads, reduceAndApply);
+
+            std::vector<std::jthread> workers;
+            workers.reserve(threads);
+            for (int t = 0; t < threads; t++) {
+                workers.emplace_back([&, t] {
+                    PerfCounters::Values start;
+                    const bool counting = PerfCounters::Read(start);
+                    for (int n = 0; n < total; n += batchSize) {
+                        PROFILE_ZONE("batch");
+                        const int realBatchSize = std::min(batchSize, total - n);
+                        const int chunk = (realBatchSize + threads - 1) / threads;
+                        const int begin = std::min(t * chunk, realBatchSize);
+                        const int end = std::min(begin + chunk, realBatchSize);
+
+                        {
+                            PROFILE_ZONE("reset");
+                            ResetGradients(partials[t]);
+                        }
+                        for (int b = begin; b < end; b++) {
+                            AccumulateGradient(X[n + b], Y[n + b], partials[t]);
+                        }
+                        PROFILE_ZONE("wait");
+                        sync.arrive_and_wait();
+                    }
+                    if (counting && PerfCounters::Read(epochCounters[t])) {
+                        epochCounters[t] = epochCounters[t] - start;
+                        counted[t] = 1;
+                    }
+                });
             }
-            ApplyGradient(realBatchSize, learningRate);
         }
 
         currentEpoch++;
-        std::cout << "[N.N. TRAINING] Epoch(s) trained: " << epoch + 1 << " / " << epochs << " (Total epochs: " << currentEpoch << ")" << std::endl;
-        SaveNetwork("neural_network_save");
+        report(true);
+        std::cout << "[N.N. TRAINING] Epoch(s) trained: " << epoch + 1 << " / " << epochs << " (Total epochs: " << currentEpoch << ") | Loss: "
+                  << progress.loss << " | Accuracy: " << progress.accuracy * 100.0 << "% | " << static_cast<long long>(progress.samplesPerSecond) << " samples/s" << std::endl;
+        if (std::ranges::find(counted, 1) != counted.end()) {
+            PerfCounters::Values epochTotal;
+            for (const auto& values : epochCounters) epochTotal += values;
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - epochStart).count();
+            std::cout << "[N.N. TRAINING] Epoch " << currentEpoch << " counters: " << epochTotal.Format(seconds) << std::endl;
+        }
+        if (!savePath.empty()) {
+            PROFILE_ZONE("checkpoint");
+            SaveNetwork(savePath);
+        }
     }
-}
\ No newline at end of file
+}
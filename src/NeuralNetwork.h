@@ -1,29 +1,80 @@
 #pragma once
+#include <functional>
 #include <string>
 #include <vector>
 
+// Running values of the epoch in progress, loss is the mean of 0.5 * sum((output - target)^2) over the samples seen so far
+struct TrainingProgress {
+    int epoch = 0;
+    int epochs = 0;
+    int totalEpochs = 0;
+    long long samples = 0;
+    long long samplesPerEpoch = 0;
+    double loss = 0.0;
+    double accuracy = 0.0;
+    double samplesPerSecond = 0.0;
+    double elapsedSeconds = 0.0;
+    double etaSeconds = 0.0;
+    bool epochDone = false;
+
+    // One line of key=value pairs, e.g. for a metrics file that is scraped or tailed
+    [[nodiscard]] std::string ToLine() const;
+};
+
 class NeuralNetwork {
 public:
     NeuralNetwork(int inputSize, int hiddenSize, int outputSize);
+    // Fixed seed for the weight initialization so training runs are reproducible
+    NeuralNetwork(int inputSize, int hiddenSize, int outputSize, unsigned int seed);
 
-    void LoadNetwork(const std::string& filePath);
+    bool LoadNetwork(const std::string& filePath);
     void SaveNetwork(const std::string& filePath) const;
     [[nodiscard]] std::vector<std::vector<float>> ActivationHeatMap(const std::vector<float>& input) const;
     [[nodiscard]] std::vector<float> RelevanceMap(const std::vector<float>& input, int outputIndex) const;
     [[nodiscard]] std::vector<float> FeedForward(const std::vector<float>& input) const;
-    void TrainNetwork(const std::vector<std::vector<float>>& X, const std::vector<std::vector<float>>& Y, float learningRate, int epochs);
+    // inputs are count x inputSize (row major, bytes are scaled by 1 / 255), outputs count x outputSize
+    void FeedForwardBatch(const float* inputs, int count, float* outputs, int threads = 1) const;
+    void FeedForwardBatch(const unsigned char* inputs, int count, float* outputs, int threads = 1) const;
+    [[nodiscard]] std::vector<float> FeedForwardBatch(const std::vector<float>& inputs, int threads = 1) const;
+    [[nodiscard]] std::vector<float> FeedForwardBatch(const std::vector<unsigned char>& inputs, int threads = 1) const;
+    // threads > 1 splits every batch across worker threads, an empty savePath skips the per-epoch save
+    void TrainNetwork(const std::vector<std::vector<float>>& X, const std::vector<std::vector<float>>& Y, float learningRate, int epochs,
+                      int threads = 1, const std::string& savePath = "neural_network_save");
+    // Called every reportEveryBatches batches and after every epoch, on the training thread (a worker when threads > 1)
+    void SetProgressCallback(std::function<void(const TrainingProgress&)> callback, int reportEveryBatches = 100);
 private:
+    friend class Attribution;
+    friend class Benchmarks;
+    friend class LiveInference;
+
+    struct Gradients {
+        std::vector<std::vector<float>> dW1;
+        std::vector<std::vector<float>> dW2;
+        std::vector<float> dB1;
+        std::vector<float> dB2;
+        double loss = 0.0;
+        int correct = 0;
+        // Scratch of AccumulateGradient, kept here so a training step does not allocate
+        std::vector<float> hidden;
+        std::vector<float> output;
+        std::vector<float> deltaOut;
+        std::vector<float> deltaHid;
+    };
+
     static float sigmoid(float x);
     static float sigmoidDerivative(float x);
 
-    void ResetGradients();
-    void AccumulateGradient(const std::vector<float>& X, const std::vector<float>& Y);
-    void ApplyGradient(int batchSize, float learningRate);
+    template <typename T>
+    void FeedForwardRange(const T* inputs, int begin, int end, float* outputs) const;
+    template <typename T>
+    void FeedForwardParallel(const T* inputs, int count, float* outputs, int threads) const;
+
+    [[nodiscard]] Gradients MakeGradients() const;
+    static void ResetGradients(Gradients& gradients);
+    static void AddGradients(Gradients& into, const Gradients& from);
+    void AccumulateGradient(const std::vector<float>& X, const std::vector<float>& Y, Gradients& gradients) const;
+    void ApplyGradient(const Gradients& gradients, int batchSize, float learningRate);
 
-    std::vector<std::vector<float>> dW1;
-    std::vector<std::vector<float>> dW2;
-    std::vector<float> dB1;
-    std::vector<float> dB2;
     int inputSize;
     int hiddenSize;
     int outputSize;
@@ -33,4 +84,6 @@ private:
     std::vector<float> b1;
     std::vector<float> b2;
     int currentEpoch = 0;
+    std::function<void(const TrainingProgress&)> progressCallback;
+    int progressInterval = 100;
 };
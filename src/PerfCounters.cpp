@@ -0,0 +1,122 @@
+#include "PerfCounters.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    std::atomic<bool> countersEnabled = false;
+    std::atomic<bool> warned = false;
+
+#ifdef __linux__
+    constexpr int counterCount = 4;
+    constexpr std::uint64_t counterConfigs[counterCount] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    // One counter group per thread, cycles is the leader so all four are scheduled together
+    struct CounterGroup {
+        int fds[counterCount] = {-1, -1, -1, -1};
+        bool opened = false;
+        bool available = false;
+
+        ~CounterGroup() {
+            for (const int fd : fds) {
+                if (fd >= 0) close(fd);
+            }
+        }
+
+        bool Open() {
+            opened = true;
+            for (int c = 0; c < counterCount; c++) {
+                perf_event_attr attr{};
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = counterConfigs[c];
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                attr.disabled = c == 0 ? 1 : 0;
+
+                fds[c] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, c == 0 ? -1 : fds[0], 0));
+                if (fds[c] < 0) {
+                    if (!warned.exchange(true)) {
+                        std::cerr << "[PERF] perf_event_open failed (" << std::strerror(errno)
+                                  << "), hardware counters disabled. Check /proc/sys/kernel/perf_event_paranoid or container permissions" << std::endl;
+                    }
+                    return false;
+                }
+            }
+            ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            available = true;
+            return true;
+        }
+    };
+#endif
+}
+
+PerfCounters::Values& PerfCounters::Values::operator+=(const Values& other) {
+    cycles += other.cycles;
+    instructions += other.instructions;
+    llcMisses += other.llcMisses;
+    branchMisses += other.branchMisses;
+    return *this;
+}
+
+PerfCounters::Values PerfCounters::Values::operator-(const Values& other) const {
+    return {cycles - other.cycles, instructions - other.instructions, llcMisses - other.llcMisses, branchMisses - other.branchMisses};
+}
+
+double PerfCounters::Values::Ipc() const {
+    return cycles == 0 ? 0.0 : static_cast<double>(instructions) / static_cast<double>(cycles);
+}
+
+std::string PerfCounters::Values::Format(const double seconds) const {
+    const double perKiloInstruction = instructions == 0 ? 0.0 : 1000.0 / static_cast<double>(instructions);
+    std::ostringstream text;
+    text << "IPC " << Ipc() << ", LLC misses " << llcMisses << " (" << static_cast<double>(llcMisses) * perKiloInstruction
+         << "/1k instr, ~" << (seconds > 0.0 ? static_cast<double>(llcMisses) * 64.0 / seconds / 1e6 : 0.0) << " MB/s)"
+         << ", branch misses " << branchMisses << " (" << static_cast<double>(branchMisses) * perKiloInstruction << "/1k instr)";
+    return text.str();
+}
+
+void PerfCounters::SetEnabled(const bool enabled) {
+    countersEnabled = enabled;
+}
+
+bool PerfCounters::Enabled() {
+    return countersEnabled.load(std::memory_order_relaxed);
+}
+
+bool PerfCounters::Read(Values& values) {
+#ifdef __linux__
+    if (!Enabled()) return false;
+    thread_local CounterGroup group;
+    if (!group.opened) group.Open();
+    if (!group.available) return false;
+
+    // nr, time_enabled, time_running, then one value per counter in group order
+    std::uint64_t buffer[3 + counterCount] = {};
+    if (read(group.fds[0], buffer, sizeof(buffer)) != static_cast<ssize_t>(sizeof(buffer))) return false;
+
+    // Scale up when the kernel had to multiplex the group with other events
+    const double scale = buffer[2] > 0 ? static_cast<double>(buffer[1]) / static_cast<double>(buffer[2]) : 1.0;
+    auto scaled = [&](const int c) { return static_cast<std::uint64_t>(static_cast<double>(buffer[3 + c]) * scale); };
+    values = {scaled(0), scaled(1), scaled(2), scaled(3)};
+    return true;
+#else
+    (void)values;
+    if (Enabled() && !warned.exchange(true)) std::cerr << "[PERF] Hardware counters are only supported on Linux" << std::endl;
+    return false;
+#endif
+}
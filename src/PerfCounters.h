@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Hardware counters of the calling thread through Linux perf_event_open (cycles, instructions, LLC misses,
+// branch misses). Off until SetEnabled(true); in containers or with a restrictive perf_event_paranoid the
+// counters cannot be opened, a single warning is printed and every read reports false.
+class PerfCounters {
+public:
+    struct Values {
+        std::uint64_t cycles = 0;
+        std::uint64_t instructions = 0;
+        std::uint64_t llcMisses = 0;
+        std::uint64_t branchMisses = 0;
+
+        Values& operator+=(const Values& other);
+        Values operator-(const Values& other) const;
+        [[nodiscard]] double Ipc() const;
+        // One line with IPC, misses per 1000 instructions and the LLC miss traffic (64 byte lines) over seconds
+        [[nodiscard]] std::string Format(double seconds) const;
+    };
+
+    static void SetEnabled(bool enabled);
+    [[nodiscard]] static bool Enabled();
+    // Reads the counters of the calling thread, opening them on the first call of every thread
+    static bool Read(Values& values);
+};
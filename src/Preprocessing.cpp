@@ -0,0 +1,108 @@
+#include "Preprocessing.h"
+
+#include <algorithm>
+#include <cmath>
+
+MnistNormalizer::MnistNormalizer(const int canvasSize)
+    : canvasSize(canvasSize), columnHits(canvasSize), integral(static_cast<size_t>(canvasSize + 1) * (canvasSize + 1), 0) {}
+
+double MnistNormalizer::Integral(double x, double y) const {
+    // The summed area table of a piecewise constant image is bilinear between the grid points
+    const int stride = boxWidth + 1;
+    x = std::clamp(x - boxLeft, 0.0, static_cast<double>(boxWidth));
+    y = std::clamp(y - boxTop, 0.0, static_cast<double>(boxHeight));
+    const int x0 = std::min(static_cast<int>(x), boxWidth - 1);
+    const int y0 = std::min(static_cast<int>(y), boxHeight - 1);
+    const double fx = x - x0, fy = y - y0;
+    const std::uint32_t* row0 = integral.data() + static_cast<size_t>(y0) * stride;
+    const std::uint32_t* row1 = row0 + stride;
+    const double top = row0[x0] + fx * (static_cast<double>(row0[x0 + 1]) - row0[x0]);
+    const double bottom = row1[x0] + fx * (static_cast<double>(row1[x0 + 1]) - row1[x0]);
+    return top + fy * (bottom - top);
+}
+
+double MnistNormalizer::Area(const double x0, const double y0, const double x1, const double y1) const {
+    return Integral(x1, y1) - Integral(x0, y1) - Integral(x1, y0) + Integral(x0, y0);
+}
+
+void MnistNormalizer::Normalize(const unsigned char* canvas, float* output) {
+    constexpr int imageSize = Preprocessing::imageSize;
+    std::fill_n(output, Preprocessing::pixelCount, 0.0f);
+
+    // Bounding box from byte ORs over rows and columns, both vectorize. Locals instead of members, a byte
+    // store could alias them and stop the vectorizer
+    const int size = canvasSize;
+    unsigned char* hits = columnHits.data();
+    std::fill_n(hits, size, 0);
+    int top = size, bottom = -1;
+    for (int y = 0; y < size; y++) {
+        const unsigned char* source = canvas + static_cast<size_t>(y) * size;
+        unsigned char hit = 0;
+        for (int x = 0; x < size; x++) {
+            hit |= source[x];
+            hits[x] |= source[x];
+        }
+        if (hit != 0) {
+            top = std::min(top, y);
+            bottom = y;
+        }
+    }
+    if (bottom < 0) return;
+    int left = 0, right = canvasSize - 1;
+    while (columnHits[left] == 0) left++;
+    while (columnHits[right] == 0) right--;
+
+    // Summed area table of the box, one pass: running sum along the row plus the table row above
+    boxLeft = left;
+    boxTop = top;
+    boxWidth = right - left + 1;
+    boxHeight = bottom - top + 1;
+    const int stride = boxWidth + 1;
+    std::fill_n(integral.data(), stride, 0u);
+    for (int y = 0; y < boxHeight; y++) {
+        const unsigned char* source = canvas + static_cast<size_t>(top + y) * canvasSize + left;
+        std::uint32_t* row = integral.data() + static_cast<size_t>(y + 1) * stride;
+        const std::uint32_t* above = row - stride;
+        row[0] = 0;
+        std::uint32_t sum = 0;
+        for (int x = 0; x < boxWidth; x++) {
+            sum += source[x];
+            row[x + 1] = above[x + 1] + sum;
+        }
+    }
+
+    // Square source region around the box, its side maps to digitSize pixels
+    const double side = std::max(boxWidth, boxHeight);
+    const double originX = left + boxWidth * 0.5 - side * 0.5;
+    const double originY = top + boxHeight * 0.5 - side * 0.5;
+    const double cell = side / digitSize;
+    const double scale = 1.0 / (cell * cell * 255.0);
+
+    float digit[digitSize * digitSize];
+    double mass = 0.0, massX = 0.0, massY = 0.0;
+    for (int y = 0; y < digitSize; y++) {
+        const double y0 = originY + y * cell;
+        for (int x = 0; x < digitSize; x++) {
+            const double x0 = originX + x * cell;
+            const double value = std::min(1.0, Area(x0, y0, x0 + cell, y0 + cell) * scale);
+            digit[y * digitSize + x] = static_cast<float>(value);
+            mass += value;
+            massX += value * (x + 0.5);
+            massY += value * (y + 0.5);
+        }
+    }
+    if (mass <= 0.0) return;
+
+    // Integer shift that moves the center of mass closest to the middle of the 28x28 image
+    const int shiftX = static_cast<int>(std::lround(imageSize * 0.5 - massX / mass));
+    const int shiftY = static_cast<int>(std::lround(imageSize * 0.5 - massY / mass));
+    for (int y = 0; y < digitSize; y++) {
+        const int targetY = y + shiftY;
+        if (targetY < 0 || targetY >= imageSize) continue;
+        for (int x = 0; x < digitSize; x++) {
+            const int targetX = x + shiftX;
+            if (targetX < 0 || targetX >= imageSize) continue;
+            output[targetY * imageSize + targetX] = digit[y * digitSize + x];
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Size of the network input every preprocessing step produces, a flat row-major 28x28 buffer
+class Preprocessing {
+public:
+    static constexpr int imageSize = 28;
+    static constexpr int pixelCount = imageSize * imageSize;
+};
+
+// MNIST style normalization of a square high resolution canvas (0-255 per pixel): the bounding box is area averaged
+// down so its longer side becomes 20 pixels (aspect ratio kept), then placed on 28x28 with its center of mass in the
+// middle. The summed area table is kept between calls, so Normalize does not allocate.
+class MnistNormalizer {
+public:
+    static constexpr int digitSize = 20;
+
+    explicit MnistNormalizer(int canvasSize);
+    // Writes Preprocessing::pixelCount floats in 0-1 to output, all zero for an empty canvas
+    void Normalize(const unsigned char* canvas, float* output);
+private:
+    // Sum of the canvas over [x0, x1) x [y0, y1), fractional edges count by covered area
+    [[nodiscard]] double Area(double x0, double y0, double x1, double y1) const;
+    [[nodiscard]] double Integral(double x, double y) const;
+
+    int canvasSize;
+    std::vector<unsigned char> columnHits;
+    // Summed area table of the bounding box only (everything outside is empty), integral[y * (boxWidth + 1) + x]
+    // is the sum of all box pixels above and left of (boxLeft + x, boxTop + y)
+    std::vector<std::uint32_t> integral;
+    int boxLeft = 0;
+    int boxTop = 0;
+    int boxWidth = 0;
+    int boxHeight = 0;
+};
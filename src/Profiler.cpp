@@ -0,0 +1,258 @@
+#include "Profiler.h"
+#include "AllocationTracker.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+namespace {
+    constexpr size_t ringCapacity = 1 << 16;
+    constexpr int bucketCount = 256;
+    // Histograms are allocated up front so a zone never allocates, zones past this limit only go to the trace
+    constexpr int maxZones = 64;
+
+    struct Event {
+        std::uint64_t start;
+        std::uint64_t end;
+        int zone;
+        int depth;
+        // Trace tid, a reused buffer still holds events of the thread it belonged to before
+        int thread;
+    };
+
+    // Log2 buckets with 4 linear sub-buckets each, about 25% resolution
+    struct Histogram {
+        std::array<std::uint64_t, bucketCount> buckets{};
+        std::uint64_t count = 0;
+        std::uint64_t totalNs = 0;
+        std::uint64_t maxNs = 0;
+        int depth = 0;
+        std::uint64_t countedCalls = 0;
+        PerfCounters::Values counters;
+        std::uint64_t allocations = 0;
+
+        static int Bucket(const std::uint64_t ns) {
+            if (ns < 8) return static_cast<int>(ns);
+            const int log = 63 - std::countl_zero(ns);
+            return log * 4 + static_cast<int>((ns >> (log - 2)) & 3);
+        }
+        static double BucketValue(const int bucket) {
+            if (bucket < 8) return bucket;
+            const int log = bucket / 4;
+            return static_cast<double>(1ULL << log) * (1.0 + (bucket % 4 + 0.5) / 4.0);
+        }
+    };
+
+    struct ThreadBuffer {
+        int threadIndex = 0;
+        int depth = 0;
+        std::vector<Event> ring = std::vector<Event>(ringCapacity);
+        std::uint64_t written = 0;
+        std::vector<Histogram> histograms = std::vector<Histogram>(maxZones);
+    };
+
+    std::mutex registryMutex;
+    std::vector<std::string> zoneNames;
+    std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+    // Buffers of exited threads, training spawns new workers every epoch and they take these over
+    std::vector<std::shared_ptr<ThreadBuffer>> freeBuffers;
+    int threadCount = 0;
+
+    struct BufferHandle {
+        std::shared_ptr<ThreadBuffer> buffer;
+
+        BufferHandle() {
+            std::lock_guard lock(registryMutex);
+            if (!freeBuffers.empty()) {
+                buffer = freeBuffers.back();
+                freeBuffers.pop_back();
+            }
+            else {
+                buffer = std::make_shared<ThreadBuffer>();
+                threadBuffers.push_back(buffer);
+            }
+            buffer->threadIndex = threadCount++;
+        }
+        ~BufferHandle() {
+            std::lock_guard lock(registryMutex);
+            buffer->depth = 0;
+            freeBuffers.push_back(buffer);
+        }
+    };
+
+    ThreadBuffer& LocalBuffer() {
+        thread_local BufferHandle handle;
+        return *handle.buffer;
+    }
+}
+
+int Profiler::RegisterZone(const char* name) {
+    std::lock_guard lock(registryMutex);
+    const auto it = std::ranges::find(zoneNames, name);
+    if (it != zoneNames.end()) return static_cast<int>(it - zoneNames.begin());
+    zoneNames.emplace_back(name);
+    return static_cast<int>(zoneNames.size()) - 1;
+}
+
+std::uint64_t Profiler::Now() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+Profiler::Zone::Zone(const int id) : id(id), start(0) {
+    LocalBuffer().depth++;
+    counting = PerfCounters::Read(startCounters);
+    startAllocations = AllocationTracker::Thread().allocations;
+    start = Now();
+}
+
+Profiler::Zone::~Zone() {
+    const std::uint64_t end = Now();
+    PerfCounters::Values endCounters;
+    const bool counted = counting && PerfCounters::Read(endCounters);
+    const std::uint64_t allocations = AllocationTracker::Thread().allocations - startAllocations;
+    ThreadBuffer& buffer = LocalBuffer();
+    buffer.depth--;
+    buffer.ring[buffer.written % ringCapacity] = {start, end, id, buffer.depth, buffer.threadIndex};
+    buffer.written++;
+
+    if (id >= maxZones) return;
+    Histogram& histogram = buffer.histograms[id];
+    const std::uint64_t ns = end - start;
+    histogram.buckets[Histogram::Bucket(ns)]++;
+    histogram.count++;
+    histogram.totalNs += ns;
+    histogram.maxNs = std::max(histogram.maxNs, ns);
+    histogram.depth = buffer.depth;
+    histogram.allocations += allocations;
+    if (counted) {
+        histogram.countedCalls++;
+        histogram.counters += endCounters - startCounters;
+    }
+}
+
+std::vector<Profiler::ZoneStats> Profiler::Summary() {
+    std::lock_guard lock(registryMutex);
+    std::vector<Histogram> merged(zoneNames.size());
+    for (const auto& buffer : threadBuffers) {
+        for (size_t z = 0; z < std::min(merged.size(), buffer->histograms.size()); z++) {
+            const Histogram& from = buffer->histograms[z];
+            if (from.count == 0) continue;
+            Histogram& into = merged[z];
+            for (int b = 0; b < bucketCount; b++) into.buckets[b] += from.buckets[b];
+            into.depth = into.count == 0 ? from.depth : std::min(into.depth, from.depth);
+            into.count += from.count;
+            into.totalNs += from.totalNs;
+            into.maxNs = std::max(into.maxNs, from.maxNs);
+            into.countedCalls += from.countedCalls;
+            into.counters += from.counters;
+            into.allocations += from.allocations;
+        }
+    }
+
+    std::vector<ZoneStats> stats;
+    for (size_t z = 0; z < merged.size(); z++) {
+        const Histogram& histogram = merged[z];
+        if (histogram.count == 0) continue;
+
+        auto percentile = [&](const double p) {
+            const auto rank = static_cast<std::uint64_t>(p * static_cast<double>(histogram.count - 1));
+            std::uint64_t seen = 0;
+            for (int b = 0; b < bucketCount; b++) {
+                seen += histogram.buckets[b];
+                // The top bucket holds the maximum, report it exactly instead of the bucket midpoint
+                if (seen == histogram.count) return static_cast<double>(histogram.maxNs);
+                if (seen > rank) return std::min(Histogram::BucketValue(b), static_cast<double>(histogram.maxNs));
+            }
+            return static_cast<double>(histogram.maxNs);
+        };
+
+        ZoneStats zone;
+        zone.name = zoneNames[z];
+        zone.depth = histogram.depth;
+        zone.count = static_cast<long long>(histogram.count);
+        zone.totalNs = static_cast<double>(histogram.totalNs);
+        zone.meanNs = zone.totalNs / static_cast<double>(histogram.count);
+        zone.p50Ns = percentile(0.50);
+        zone.p99Ns = percentile(0.99);
+        zone.maxNs = static_cast<double>(histogram.maxNs);
+        zone.hasCounters = histogram.countedCalls > 0;
+        zone.counters = histogram.counters;
+        zone.allocations = histogram.allocations;
+        stats.push_back(zone);
+    }
+    return stats;
+}
+
+void Profiler::PrintSummary() {
+    if (!enabled) {
+        std::cout << "[PROFILER] Built without DIGITNET_PROFILING, no zones recorded" << std::endl;
+        return;
+    }
+
+    const auto summary = Summary();
+    std::cout << "[PROFILER] Zone                     Count     Total ms   Mean us    p50 us    p99 us" << std::endl;
+    for (const auto& zone : summary) {
+        std::cout << "[PROFILER] " << std::left << std::setw(22) << std::string(zone.depth * 2, ' ') + zone.name << std::right
+                  << std::setw(8) << zone.count << std::fixed << std::setprecision(2)
+                  << std::setw(13) << zone.totalNs / 1e6 << std::setw(10) << zone.meanNs / 1e3
+                  << std::setw(10) << zone.p50Ns / 1e3 << std::setw(10) << zone.p99Ns / 1e3 << std::defaultfloat << std::endl;
+    }
+    if (AllocationTracker::enabled) {
+        for (const auto& zone : summary) {
+            std::cout << "[PROFILER] " << zone.name << ": " << zone.allocations << " allocation(s), "
+                      << static_cast<double>(zone.allocations) / static_cast<double>(zone.count) << " per call" << std::endl;
+        }
+    }
+    for (const auto& zone : summary) {
+        if (zone.hasCounters) std::cout << "[PROFILER] " << zone.name << ": " << zone.counters.Format(zone.totalNs / 1e9) << std::endl;
+    }
+}
+
+bool Profiler::WriteChromeTrace(const std::string& filePath) {
+    std::ofstream out(filePath);
+    if (!out.is_open()) {
+        std::cerr << "[PROFILER] Cannot open path: " << filePath << std::endl;
+        return false;
+    }
+
+    std::lock_guard lock(registryMutex);
+    std::uint64_t origin = UINT64_MAX;
+    for (const auto& buffer : threadBuffers) {
+        const std::uint64_t count = std::min<std::uint64_t>(buffer->written, ringCapacity);
+        for (std::uint64_t i = buffer->written - count; i < buffer->written; i++) {
+            origin = std::min(origin, buffer->ring[i % ringCapacity].start);
+        }
+    }
+
+    out << "{\"traceEvents\": [";
+    bool first = true;
+    out << std::fixed << std::setprecision(3);
+    for (const auto& buffer : threadBuffers) {
+        // Only the newest ringCapacity zones of every thread survive
+        const std::uint64_t count = std::min<std::uint64_t>(buffer->written, ringCapacity);
+        for (std::uint64_t i = buffer->written - count; i < buffer->written; i++) {
+            const Event& e = buffer->ring[i % ringCapacity];
+            out << (first ? "\n" : ",\n") << "{\"name\": \"" << zoneNames[e.zone] << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.thread
+                << ", \"ts\": " << static_cast<double>(e.start - origin) / 1e3 << ", \"dur\": " << static_cast<double>(e.end - e.start) / 1e3
+                << ", \"args\": {\"depth\": " << e.depth << "}}";
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+    std::cout << "[PROFILER] Trace written to: " << filePath << std::endl;
+    return true;
+}
+
+void Profiler::Reset() {
+    std::lock_guard lock(registryMutex);
+    for (const auto& buffer : threadBuffers) {
+        buffer->written = 0;
+        std::ranges::fill(buffer->histograms, Histogram{});
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "PerfCounters.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scoped profiling zones, compiled in with -DDIGITNET_PROFILING (CMake option DIGITNET_PROFILING).
+// Every thread writes its zones into its own ring buffer and per-zone histogram, so a zone costs two clock
+// reads and no locking. Summary and export must only run while no profiled code is executing.
+// With PerfCounters enabled every zone also reads the hardware counters of its thread (one syscall per edge),
+// with DIGITNET_TRACK_ALLOCATIONS it counts the allocations made on its thread.
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#ifdef DIGITNET_PROFILING
+#define PROFILE_ZONE(name) \
+    static const int PROFILE_CONCAT(profileZoneId, __LINE__) = Profiler::RegisterZone(name); \
+    const Profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(PROFILE_CONCAT(profileZoneId, __LINE__))
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
+
+class Profiler {
+public:
+#ifdef DIGITNET_PROFILING
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+    struct ZoneStats {
+        std::string name;
+        int depth = 0;
+        long long count = 0;
+        double totalNs = 0.0;
+        double meanNs = 0.0;
+        double p50Ns = 0.0;
+        double p99Ns = 0.0;
+        double maxNs = 0.0;
+        // Summed over all calls, only filled when PerfCounters were enabled and available
+        bool hasCounters = false;
+        PerfCounters::Values counters;
+        std::uint64_t allocations = 0;
+    };
+
+    class Zone {
+    public:
+        explicit Zone(int id);
+        ~Zone();
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+    private:
+        int id;
+        std::uint64_t start;
+        bool counting;
+        PerfCounters::Values startCounters;
+        std::uint64_t startAllocations;
+    };
+
+    static int RegisterZone(const char* name);
+    static std::uint64_t Now();
+
+    [[nodiscard]] static std::vector<ZoneStats> Summary();
+    static void PrintSummary();
+    // Chrome trace event format, opens in chrome://tracing and ui.perfetto.dev
+    static bool WriteChromeTrace(const std::string& filePath);
+    static void Reset();
+};
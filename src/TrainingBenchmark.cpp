@@ -0,0 +1,144 @@
+#include "TrainingBenchmark.h"
+#include "NeuralNetwork.h"
+#include "MNISTloader.h"
+#include "Evaluator.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+std::string TrainingBenchmark::Result::ToJson() const {
+    std::ostringstream json;
+    json << "{\n";
+    json << "  \"seed\": " << settings.seed << ",\n";
+    json << "  \"threads\": " << settings.threads << ",\n";
+    json << "  \"learning_rate\": " << settings.learningRate << ",\n";
+    json << "  \"target_accuracy\": " << settings.targetAccuracy << ",\n";
+    json << "  \"samples_per_second\": " << samplesPerSecond << ",\n";
+    json << "  \"epoch_seconds\": " << epochSeconds << ",\n";
+    json << "  \"time_to_target_seconds\": " << timeToTargetSeconds << ",\n";
+    json << "  \"final_accuracy\": " << finalAccuracy << ",\n";
+    json << "  \"peak_rss_kb\": " << peakRssKb << ",\n";
+    json << "  \"epochs\": [";
+    for (size_t i = 0; i < epochs.size(); i++) {
+        const Epoch& e = epochs[i];
+        json << (i > 0 ? "," : "") << "\n    {\"epoch\": " << e.epoch << ", \"seconds\": " << e.seconds
+             << ", \"samples_per_second\": " << e.samplesPerSecond << ", \"accuracy\": " << e.accuracy << "}";
+    }
+    json << "\n  ]\n}\n";
+    return json.str();
+}
+
+long long TrainingBenchmark::PeakRssKb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return static_cast<long long>(counters.PeakWorkingSetSize / 1024);
+    return 0;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+TrainingBenchmark::Result TrainingBenchmark::Run(const Settings& settings) {
+    const auto images = MNISTloader::LoadImages(settings.trainImages);
+    const auto labels = MNISTloader::LoadLabels(settings.trainLabels);
+    const auto testImages = MNISTloader::LoadImageBytes(settings.testImages);
+    const auto testLabels = MNISTloader::LoadLabels(settings.testLabels);
+
+    std::vector<std::vector<float>> Y;
+    Y.reserve(labels.size());
+    for (const int label : labels) {
+        std::vector oneHot(10, 0.0f);
+        oneHot[label] = 1.0f;
+        Y.push_back(oneHot);
+    }
+
+    Result result;
+    result.settings = settings;
+    NeuralNetwork network(784, 64, 10, settings.seed);
+    ThreadPool pool(settings.threads);
+
+    double trainingSeconds = 0.0;
+    for (int epoch = 1; epoch <= settings.maxEpochs; epoch++) {
+        const auto start = std::chrono::steady_clock::now();
+        network.TrainNetwork(images, Y, settings.learningRate, 1, settings.threads, "");
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        trainingSeconds += seconds;
+
+        const EvaluationReport report = Evaluator::Evaluate(network, testImages, testLabels, pool);
+        result.epochs.push_back({epoch, seconds, static_cast<double>(images.size()) / seconds, report.accuracy});
+        std::cout << "[E2E BENCH] Epoch " << epoch << ": " << seconds << " s, " << result.epochs.back().samplesPerSecond
+                  << " samples/s, test accuracy " << report.accuracy * 100.0 << "%" << std::endl;
+
+        if (report.accuracy >= settings.targetAccuracy) {
+            result.timeToTargetSeconds = trainingSeconds;
+            break;
+        }
+    }
+
+    if (!result.epochs.empty()) {
+        result.epochSeconds = trainingSeconds / static_cast<double>(result.epochs.size());
+        result.samplesPerSecond = static_cast<double>(images.size()) / result.epochSeconds;
+        result.finalAccuracy = result.epochs.back().accuracy;
+    }
+    result.peakRssKb = PeakRssKb();
+    return result;
+}
+
+double TrainingBenchmark::ReadNumber(const std::string& json, const std::string& key, const double fallback) {
+    const auto position = json.find("\"" + key + "\":");
+    if (position == std::string::npos) return fallback;
+    try {
+        return std::stod(json.substr(position + key.size() + 3));
+    }
+    catch (const std::exception&) {
+        return fallback;
+    }
+}
+
+bool TrainingBenchmark::CompareToBaseline(const Result& result, const std::string& baselineJson, const double threshold) {
+    struct Metric {
+        const char* key;
+        double current;
+        bool higherIsBetter;
+    };
+    const Metric metrics[] = {
+        {"samples_per_second", result.samplesPerSecond, true},
+        {"epoch_seconds", result.epochSeconds, false},
+        {"time_to_target_seconds", result.timeToTargetSeconds, false},
+        {"final_accuracy", result.finalAccuracy, true},
+        {"peak_rss_kb", static_cast<double>(result.peakRssKb), false},
+    };
+
+    bool regression = false;
+    for (const auto& [key, current, higherIsBetter] : metrics) {
+        const double baseline = ReadNumber(baselineJson, key, -1.0);
+        if (baseline <= 0.0) continue;
+        if (current < 0.0) {
+            std::cout << "[E2E BENCH] REGRESSION " << key << ": target not reached, baseline " << baseline << std::endl;
+            regression = true;
+            continue;
+        }
+
+        const double change = (current - baseline) / baseline;
+        const bool worse = higherIsBetter ? change < -threshold : change > threshold;
+        std::cout << "[E2E BENCH] " << (worse ? "REGRESSION " : "") << key << ": " << current << " (baseline " << baseline
+                  << ", " << (change >= 0 ? "+" : "") << change * 100.0 << "%)" << std::endl;
+        regression |= worse;
+    }
+    return regression;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// End-to-end benchmark: trains a freshly seeded network and evaluates it on the test set after every
+// epoch until the target accuracy or the epoch limit is reached
+class TrainingBenchmark {
+public:
+    struct Settings {
+        unsigned int seed = 1;
+        int threads = 1;
+        float learningRate = 0.1f;
+        double targetAccuracy = 0.97;
+        int maxEpochs = 30;
+        std::string trainImages = "data/train-images.idx3-ubyte";
+        std::string trainLabels = "data/train-labels.idx1-ubyte";
+        std::string testImages = "data/t10k-images.idx3-ubyte";
+        std::string testLabels = "data/t10k-labels.idx1-ubyte";
+    };
+    struct Epoch {
+        int epoch = 0;
+        double seconds = 0.0;
+        double samplesPerSecond = 0.0;
+        double accuracy = 0.0;
+    };
+    struct Result {
+        Settings settings;
+        std::vector<Epoch> epochs;
+        double samplesPerSecond = 0.0;
+        double epochSeconds = 0.0;
+        // Training time only, the evaluations in between are not counted, -1 when the target was not reached
+        double timeToTargetSeconds = -1.0;
+        double finalAccuracy = 0.0;
+        long long peakRssKb = 0;
+
+        [[nodiscard]] std::string ToJson() const;
+    };
+
+    static Result Run(const Settings& settings);
+    // Prints every metric that is worse than the baseline by more than threshold (0.1 = 10%), returns true on regression
+    static bool CompareToBaseline(const Result& result, const std::string& baselineJson, double threshold);
+    static long long PeakRssKb();
+private:
+    static double ReadNumber(const std::string& json, const std::string& key, double fallback);
+};
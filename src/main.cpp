@@ -1,39 +1,78 @@
 #include "../CPLibrary/CPLibrary.h"
 #include "NeuralNetwork.h"
+#include "Attribution.h"
+#include "Brush.h"
 #include "CustomLoader.h"
 #include "MNISTloader.h"
+#include "Preprocessing.h"
+#include "CommandLine.h"
+#include "Evaluator.h"
+#include "LiveInference.h"
+#include "ThreadPool.h"
 #include "TimerChrono.h"
 
+#include <future>
+#include <optional>
+#include <memory>
+#include <thread>
+
 using namespace CPL;
 PRIORITIZE_GPU_BY_VENDOR
 
-const auto trainImages = MNISTloader::LoadImages("data/train-images.idx3-ubyte");
-const auto trainLabels = MNISTloader::LoadLabels("data/train-labels.idx1-ubyte");
-const auto testImages = MNISTloader::LoadImages("data/t10k-images.idx3-ubyte");
-const auto testLabels = MNISTloader::LoadLabels("data/t10k-labels.idx1-ubyte");
-const auto customTrainImagesLabels = CustomLoader::LoadImages("custom-train-images-and-labels");
+std::vector<std::vector<float>> trainImages;
+std::vector<int> trainLabels;
+std::vector<unsigned char> testImages;
+std::vector<int> testLabels;
+std::vector<std::pair<std::vector<float>, int>> customTrainImagesLabels;
 std::vector<std::vector<float>> Y;
+// Filled in the background so the window opens right away, WaitForDatasets before using any of the above
+std::future<void> datasets;
+std::unique_ptr<ThreadPool> evaluationPool;
+std::future<EvaluationReport> evaluation;
+TrainingProgress lastTraining;
 
 int pixelSize = 30;
 int imageSize = 28;
-std::vector imageDrawn(imageSize, std::vector(imageSize, 0.0f));
+// Flat row-major 28x28 grid shown in the window, the digit itself is drawn into the full resolution canvas
+// and networkInput receives its MNIST style normalized copy
+std::vector imageDrawn(imageSize * imageSize, 0.0f);
+std::vector networkInput(imageSize * imageSize, 0.0f);
+constexpr int canvasSize = 280 * 3;
+constexpr float brushRadius = 30.0f;
+std::vector<unsigned char> canvas(canvasSize * canvasSize, 0);
+// The same stroke on both grids, the canvas has one cell per window pixel and the display grid one per pixelSize
+const Brush canvasBrush(brushRadius);
+const Brush gridBrush(brushRadius / static_cast<float>(pixelSize));
+// Window position of the last painted point while the button is held, strokes continue from it
+std::optional<glm::vec2> lastBrushPosition;
+MnistNormalizer normalizer(canvasSize);
+bool canvasChanged = false;
+bool liveMode = false;
 bool showHeatMap = false;
+// Class shown by the heat map, 0-9 switch it using the relevances of the last prediction
+int heatMapClass = 0;
 std::vector<float> relevance;
 
-void HandleInput(NeuralNetwork& network);
-std::vector<std::vector<float>> CenterImage(std::vector<std::vector<float>> image);
-std::vector<std::vector<float>> SmoothImage(const std::vector<std::vector<float>>& image);
-std::vector<std::vector<float>> GaussianBlur(const std::vector<std::vector<float>>& image);
+void HandleInput(NeuralNetwork& network, LiveInference& live, Attribution& attribution);
+void PollEvaluation();
+void LoadDatasets();
+void WaitForDatasets();
+void Paint(glm::vec2 from, glm::vec2 to);
+bool EvaluationRunning();
 Color HeatColor(float v);
 
-int main() {
-    for (const int label : trainLabels) {
-        std::vector oneHot(10, 0.0f);
-        oneHot[label] = 1.0;
-        Y.push_back(oneHot);
-    }
+int main(const int argc, char** argv) {
+    if (argc > 1) return CommandLine::Run(argc, argv);
+
+    datasets = std::async(std::launch::async, LoadDatasets);
+    evaluationPool = std::make_unique<ThreadPool>(static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
 
     NeuralNetwork network(784, 64, 10);
+    // Training blocks the window, the last values stay on screen afterwards
+    network.SetProgressCallback([](const TrainingProgress& progress) {
+        lastTraining = progress;
+        RequestRedraw();
+    });
     {
         auto timer = TimerChrono("Loading network from files took");
         network.LoadNetwork("neural_network_save");
@@ -56,101 +95,115 @@ int main() {
         */
     }
 
+    LiveInference live(network);
+    Attribution attribution(network);
     InitWindow(280 * 3, 280 * 3, "Neural Network");
+    // Drawing and heat map as 28x28 textures, only rows that changed are uploaded
+    CanvasTexture drawingCanvas(imageSize, imageSize);
+    CanvasTexture heatMapCanvas(imageSize, imageSize);
+    // Only redraw after input, timers or training progress, an idle window sleeps in WaitEvents
+    SetEventDriven(true);
 
     while (!WindowShouldClose()) {
         UpdateCPL();
 
-        HandleInput(network);
-
-        ClearBackground(showHeatMap && !relevance.empty() ? Color(150, 150, 150, 255) : BLACK);
-        BeginDrawing(SHAPE_2D, false);
-        for (int h = 0; h < imageSize; h++) {
-            DrawLine({0, h * 30}, {GetScreenWidth(), h * 30}, Color(255, 255, 255, 50));
+        HandleInput(network, live, attribution);
+        PollEvaluation();
+        if (liveMode && canvasChanged) {
+            normalizer.Normalize(canvas.data(), networkInput.data());
+            live.Update(networkInput.data());
+            canvasChanged = false;
         }
-        for (int w = 0; w < imageSize; w++) {
-            DrawLine({w * 30, 0}, {w * 30, GetScreenHeight()}, Color(255, 255, 255, 50));
+        if (!BeginFrame()) {
+            WaitEvents();
+            continue;
         }
 
-        if (showHeatMap && !relevance.empty()) {
-            for (int h = 0; h < imageSize; h++) {
-                for (int w = 0; w < imageSize; w++) {
-                    const float value = relevance[h * imageSize + w];
-                    Color c = {
-                        255,
-                        255 * (1.0f - value),
-                        0,
-                        150
-                    };
-                    DrawRectangle({w * pixelSize, h * pixelSize}, {pixelSize, pixelSize}, c);
-                }
-            }
-        }
-        for (int h = 0 ; h < imageSize; h++) {
+        ClearBackground(showHeatMap && !relevance.empty() ? Color(150, 150, 150, 255) : BLACK);
+        const glm::vec2 gridSize = {imageSize * pixelSize, imageSize * pixelSize};
+        const bool heatMapVisible = showHeatMap && !relevance.empty();
+        for (int h = 0; h < imageSize; h++) {
             for (int w = 0; w < imageSize; w++) {
-                if (const float pixel = imageDrawn[h][w];
-                    pixel != 0.0f) {
-                    if (showHeatMap) DrawRectangleOutline({w * pixelSize, h * pixelSize}, {pixelSize, pixelSize}, Color{255, 255, 255, 150});
-                    else DrawRectangle({w * pixelSize, h * pixelSize}, {pixelSize, pixelSize}, Color{255, 255, 255, 255});
-                    }
+                drawingCanvas.SetPixel(w, h, Color(255, 255, 255, 255 * imageDrawn[h * imageSize + w]));
+                if (heatMapVisible) heatMapCanvas.SetPixel(w, h, Color{255, 255 * (1.0f - relevance[h * imageSize + w]), 0, 150});
             }
         }
 
+        BeginDrawing(SHAPE_2D, false);
+        DrawCanvasGrid(drawingCanvas, {0, 0}, gridSize, Color(255, 255, 255, 50));
+
+        BeginDrawing(TEXTURE_2D, false);
+        if (heatMapVisible) DrawCanvas(heatMapCanvas, {0, 0}, gridSize, WHITE);
+        // Over the heat map the drawing only shows through faintly
+        DrawCanvas(drawingCanvas, {0, 0}, gridSize, heatMapVisible ? Color{255, 255, 255, 70} : WHITE);
+
         BeginDrawing(TEXT, false);
         ShowDetails();
+        if (lastTraining.epoch > 0) {
+            const std::string trainingText = "Epoch " + std::to_string(lastTraining.epoch) + " / " + std::to_string(lastTraining.epochs)
+                + " | Loss: " + std::to_string(lastTraining.loss) + " | Accuracy: " + std::to_string(lastTraining.accuracy * 100.0) + "% | "
+                + std::to_string(static_cast<long long>(lastTraining.samplesPerSecond)) + " samples/s | ETA "
+                + std::to_string(static_cast<long long>(lastTraining.etaSeconds)) + " s";
+            BeginDrawing(TEXT, false);
+            DrawTextShadow({0, 165}, {2, 2}, 0.3, trainingText, WHITE, DARK_GRAY);
+        }
+        if (liveMode) {
+            const int digit = live.Prediction();
+            const std::string liveText = "Live: " + std::to_string(digit) + " | Probability: " + std::to_string(live.Outputs()[digit] * 100.0f) + "%";
+            BeginDrawing(TEXT, false);
+            DrawTextShadow({0, 200}, {2, 2}, 0.3, liveText, WHITE, DARK_GRAY);
+        }
+        if (showHeatMap && !relevance.empty()) {
+            BeginDrawing(TEXT, false);
+            DrawTextShadow({0, 235}, {2, 2}, 0.3, "Relevance for " + std::to_string(heatMapClass) + " (0-9 to switch)", WHITE, DARK_GRAY);
+        }
 
         EndDrawing();
 
         glfwSwapBuffers(window);
-        glfwPollEvents();
+        WaitEvents();
     }
+    if (evaluation.valid()) evaluation.wait();
+    drawingCanvas.Unload();
+    heatMapCanvas.Unload();
     CloseWindow();
 }
 
-void HandleInput(NeuralNetwork& network) {
-    if (IsKeyPressedOnce(KEY_ENTER)) {
+void HandleInput(NeuralNetwork& network, LiveInference& live, Attribution& attribution) {
+    if (IsKeyPressedOnce(KEY_ENTER) && !EvaluationRunning()) {
+        WaitForDatasets();
         network.TrainNetwork(trainImages, Y, 0.1, 1);
+        live.Synchronize();
+        canvasChanged = true;
+    }
+    if (IsKeyPressedOnce(KEY_L)) {
+        liveMode = !liveMode;
+        canvasChanged = true;
+        std::cout << "[N.N. LIVE] Live prediction " << (liveMode ? "on" : "off") << std::endl;
     }
     if (IsKeyPressedOnce(KEY_R)) {
-        for (int h = 0; h < imageSize; h++) {
-            for (int w = 0; w < imageSize; w++) {
-                imageDrawn[h][w] = 0.0f;
-            }
-        }
+        std::ranges::fill(imageDrawn, 0.0f);
+        std::ranges::fill(canvas, 0);
+        canvasChanged = true;
         relevance.clear();
     }
     if (IsMouseDown(MOUSE_BUTTON_LEFT)) {
-        glm::vec2 mousePos = GetMousePosition();
-        for (int h = 0; h < imageSize; h++) {
-            for (int w = 0; w < imageSize; w++) {
-                Rectangle pixel({w * pixelSize, h * pixelSize}, {pixelSize, pixelSize}, WHITE);
-                if (Circle pixelCircle(mousePos, 30.f, WHITE);
-                    CheckCollisionCircleRect(pixelCircle, pixel) && imageDrawn[h][w] < 1.0f) {
-                    imageDrawn[h][w] = 1.0f;
-                }
-            }
-        }
+        const glm::vec2 mousePos = GetMousePosition();
+        Paint(lastBrushPosition.value_or(mousePos), mousePos);
+        lastBrushPosition = mousePos;
+    }
+    else {
+        lastBrushPosition.reset();
     }
     if (IsKeyPressedOnce(KEY_SPACE)) {
-        auto centeredImage = CenterImage(imageDrawn);
-        auto blurred = GaussianBlur(centeredImage);
-        std::vector<float> input;
-        std::vector<float> smoothedInput;
-        input.reserve(imageSize * imageSize);
-        for (int h = 0; h < imageSize; h++) {
-            for (int w = 0; w < imageSize; w++) {
-                input.push_back(blurred[h][w]);
-            }
-        }
-        auto outputs = network.FeedForward(input);
-
-        int predicted = static_cast<int>(std::distance(outputs.begin(), std::max_element(outputs.begin(), outputs.end())));
-        relevance = network.RelevanceMap(input, predicted);
-        float maxVal = *std::max_element(relevance.begin(), relevance.end());
-        float minVal = *std::min_element(relevance.begin(), relevance.end());
-        for (auto& v : relevance) {
-            v = (v - minVal) / (maxVal - minVal);
-        }
+        normalizer.Normalize(canvas.data(), networkInput.data());
+        // One forward pass gives the outputs and the relevances of every class
+        attribution.Compute(networkInput.data());
+        const std::vector<float>& outputs = attribution.Outputs();
+
+        heatMapClass = attribution.Prediction();
+        relevance.resize(networkInput.size());
+        attribution.NormalizedRelevance(heatMapClass, relevance.data());
 
         std::cout << "------------------------------------------------------\n";
         std::cout << "Result" << std::endl;
@@ -159,41 +212,31 @@ void HandleInput(NeuralNetwork& network) {
         for (int number = 0; number < 10; number++) {
             std::cout << number << ": " << outputs[number] * 100 << "%" << std::endl;
         }
-        std::vector<float>::iterator result;
-        result = std::max_element(outputs.begin(), outputs.end());
-        int index = static_cast<int>(std::distance(outputs.begin(), result));
+        int index = attribution.Prediction();
 
         std::cout << "------------------------------------------------------\n";
         std::cout << "The number shown is: " << index << " | Probability: " << outputs[index] * 100 << "%" << std::endl;
         std::cout << "------------------------------------------------------\n";
     }
+    for (int digit = 0; digit < 10; digit++) {
+        if (IsKeyPressedOnce(KEY_0 + digit) && !relevance.empty()) {
+            heatMapClass = digit;
+            attribution.NormalizedRelevance(heatMapClass, relevance.data());
+            std::cout << "[N.N. HEAT MAP] Showing relevance for " << digit << std::endl;
+        }
+    }
     if (IsKeyDown(GLFW_KEY_LEFT_SHIFT)) {
         showHeatMap = true;
     }
     else {
         showHeatMap = false;
     }
-    if (IsKeyPressedOnce(KEY_T)) {
-        auto timer = TimerChrono("Testing network took");
-
-        int correct = 0;
-        const int total = static_cast<int>(testImages.size());
-
-        for (int i = 0; i < total; i++) {
-            auto output = network.FeedForward(testImages[i]);
-
-            const int predicted = static_cast<int>(std::distance(output.begin(),
-                                                                 std::max_element(output.begin(), output.end())));
-
-            if (const int actual = testLabels[i];
-                predicted == actual)
-                correct++;
-        }
-
-        const double accuracy = 100.0 * correct / total;
-        std::cout << "[N.N. TEST] Test accuracy: " << accuracy << "% (" << correct << "/" << total << ")" << std::endl;
+    if (IsKeyPressedOnce(KEY_T) && !evaluation.valid()) {
+        WaitForDatasets();
+        std::cout << "[N.N. TEST] Testing network in the background..." << std::endl;
+        evaluation = Evaluator::EvaluateAsync(network, testImages, testLabels, *evaluationPool);
     }
-    if (IsKeyPressedOnce(KEY_W)) {
+    if (IsKeyPressedOnce(KEY_W) && !EvaluationRunning()) {
         std::cout << "[N.N. DYNAMIC TRAINER] Solution is wrong?" << std::endl;
         std::cout << "[N.N. DYNAMIC TRAINER] Enter the number between 0 and 9: " << std::endl;
         int label = 0;
@@ -219,25 +262,21 @@ void HandleInput(NeuralNetwork& network) {
             return;
         }
 
-        CustomLoader::SaveImage(imageDrawn, label, "custom-train-images-and-labels", imageSize);
+        normalizer.Normalize(canvas.data(), networkInput.data());
+        // The background load may still be reading the file this appends to
+        WaitForDatasets();
+        CustomLoader::SaveImage(networkInput, label, "custom-train-images-and-labels");
 
         std::vector y(10, 0.0f);
         y[label] = 1.0f;
         std::vector<std::vector<float>> m_Y = {y};
-        auto centeredImage = CenterImage(imageDrawn);
-        auto blurred = GaussianBlur(centeredImage);
-        std::vector<float> input;
-        input.reserve(imageSize * imageSize);
-        for (int h = 0; h < imageSize; h++) {
-            for (int w = 0; w < imageSize; w++) {
-                input.push_back(blurred [h][w]);
-            }
-        }
-        std::vector<std::vector<float>> m_X = {input};
+        std::vector<std::vector<float>> m_X = {networkInput};
 
         network.TrainNetwork(m_X, m_Y, rate, epochs);
+        live.Synchronize();
+        canvasChanged = true;
     }
-    if (IsKeyPressedOnce(KEY_I)) {
+    if (IsKeyPressedOnce(KEY_I) && !EvaluationRunning()) {
         std::cout << "[N.N. DYNAMIC TRAINER] Set the learn rate (recommended 0.01 or 0.1): " << std::endl;
         float rate = 0.0f;
         std::cin >> rate;
@@ -254,68 +293,57 @@ void HandleInput(NeuralNetwork& network) {
             return;
         }
 
+        WaitForDatasets();
         auto timer = TimerChrono("Training network took");
         network.TrainNetwork(trainImages, Y, rate, epochs);
+        live.Synchronize();
+        canvasChanged = true;
     }
     if (IsKeyPressedOnce(KEY_ESCAPE)) glfwSetWindowShouldClose(window, true);
 }
 
-std::vector<std::vector<float>> CenterImage(std::vector<std::vector<float>> image) {
-    int top = imageSize, bottom = 0, left = imageSize, right = 0;
-
-    for (int y = 0; y < imageSize; y++) {
-        for (int x = 0; x < imageSize; x++) {
-            if (image[y][x] > 0.1f) {
-                top = std::min(top, y);
-                bottom = std::max(bottom, y);
-                left = std::min(left, x);
-                right = std::max(right, x);
-            }
-        }
+void PollEvaluation() {
+    if (evaluation.valid() && evaluation.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        evaluation.get().Print();
     }
+}
 
-    if (top >= bottom || left >= right) return image;
-
-    const int h = bottom - top + 1;
-    const int w = right - left + 1;
-
-    std::vector temp(imageSize, std::vector(imageSize, 0.0f));
+void LoadDatasets() {
+    auto timer = TimerChrono("Loading datasets took");
+    trainImages = MNISTloader::LoadImages("data/train-images.idx3-ubyte");
+    trainLabels = MNISTloader::LoadLabels("data/train-labels.idx1-ubyte");
+    testImages = MNISTloader::LoadImageBytes("data/t10k-images.idx3-ubyte");
+    testLabels = MNISTloader::LoadLabels("data/t10k-labels.idx1-ubyte");
+    customTrainImagesLabels = CustomLoader::LoadImages("custom-train-images-and-labels");
 
-    const int offY = (28 - h) / 2;
-    const int offX = (28 - w) / 2;
+    for (const int label : trainLabels) {
+        std::vector oneHot(10, 0.0f);
+        oneHot[label] = 1.0;
+        Y.push_back(oneHot);
+    }
+}
 
-    for (int y = 0; y < h; y++) {
-        for (int x = 0; x < w; x++) {
-            temp[offY + y][offX + x] = image[top + y][left + x];
-        }
+void WaitForDatasets() {
+    if (!datasets.valid()) return;
+    if (datasets.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        std::cout << "[DATA] Waiting for the datasets to finish loading..." << std::endl;
     }
+    datasets.get();
+}
 
-    image = std::move(temp);
-    return image;
+// Full resolution brush, same radius as the circle that marks the grid cells
+void Paint(const glm::vec2 from, const glm::vec2 to) {
+    canvasBrush.Stroke(canvas.data(), canvasSize, canvasSize, from.x, from.y, to.x, to.y);
+    const float cell = static_cast<float>(pixelSize);
+    gridBrush.Stroke(imageDrawn.data(), imageSize, imageSize, from.x / cell, from.y / cell, to.x / cell, to.y / cell);
+    canvasChanged = true;
 }
 
-std::vector<std::vector<float>> GaussianBlur(const std::vector<std::vector<float>>& image) {
-    const int size = static_cast<int>(image.size());
-    std::vector out (size, std::vector(size, 0.0f));
-
-    for (int h = 1; h < size - 1; h++) {
-        for (int w = 1; w < size - 1; w++) {
-            float sum = 0.0f;
-
-            for (int ky = -1; ky <= 1; ky++) {
-                for (int kx = -1; kx <= 1; kx++) {
-                    constexpr float kernel[3][3] {
-                        {1, 2, 1},
-                        {2, 4, 2},
-                        {1, 2, 1}
-                    };
-                    sum += image[h + ky][w + kx] * kernel[ky + 1][kx + 1];
-                }
-            }
-            out[h][w] = sum / 16.0f;
-        }
-    }
-    return out;
+// Training while the test runs would change the weights under the evaluation threads
+bool EvaluationRunning() {
+    if (!evaluation.valid()) return false;
+    std::cerr << "[N.N. TEST] Wait for the running test to finish before training" << std::endl;
+    return true;
 }
 
 Color HeatColor(float v) {
@@ -327,17 +355,3 @@ Color HeatColor(float v) {
 
     return Color(static_cast<uint8_t>(r * 255), static_cast<uint8_t>(g * 255), static_cast<uint8_t>(b * 255), 150);
 }
-
-std::vector<std::vector<float>> SmoothImage(const std::vector<std::vector<float>>& image) {
-    auto out = image;
-    for (int h = 1; h < imageSize - 1; h++) {
-        for (int w = 1; w < imageSize - 1; w++) {
-            out[h][w] = (image[h][w]
-                + image[h -1][w]
-                + image[h + 1][w]
-                + image[h][w - 1]
-                + image[h][w + 1]) / 0.5f;
-        }
-    }
-    return out;
-}
@@ -0,0 +1,5 @@
+#include "CommandLine.h"
+
+int main(const int argc, char** argv) {
+    return CommandLine::Run(argc, argv);
+}